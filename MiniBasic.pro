@@ -1,34 +1,18 @@
-QT       += core gui
+TEMPLATE = subdirs
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+# core: tokenizer, parser and program, as a static library without Qt
+# gui:  the Qt widgets application
+# cli:  a command line runner for batch use
+# bench: micro benchmarks of the core, printing JSON lines
+# tests: regression tests of the core, failing with a non-zero exit code
+SUBDIRS += \
+    core \
+    gui \
+    cli \
+    bench \
+    tests
 
-CONFIG += c++11
-
-# You can make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-SOURCES += \
-    exp.cpp \
-    main.cpp \
-    mainwindow.cpp \
-    parser.cpp \
-    program.cpp \
-    statement.cpp \
-    tokenizer.cpp
-
-HEADERS += \
-    exp.h \
-    mainwindow.h \
-    parser.h \
-    program.h \
-    statement.h \
-    tokenizer.h
-
-FORMS += \
-    mainwindow.ui
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
+gui.depends = core
+cli.depends = core
+bench.depends = core
+tests.depends = core
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = qbasic-bench
+
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../core/core.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,298 @@
+#include "program.h"
+#include "parser.h"
+#include "loader.h"
+#include "cache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Micro benchmarks of the core library.
+ * Every result is printed as one JSON object per line:
+ *   {"bench": ..., "case": ..., "unit": ..., "ops": ..., "seconds": ...,
+ *    "ns_per_op": ..., "ops_per_sec": ..., "allocs_per_op": ...}
+ * so that runs before and after a change can be compared by a script.
+ * An argument, if given, only runs the benchmarks whose name contains it.
+ */
+
+/* every operator new is counted, to report allocations per operation */
+static long long allocations = 0;
+
+void *operator new(std::size_t size) {
+    allocations++;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+/* least time a benchmark runs for, in seconds */
+static const double MIN_TIME = 0.2;
+
+static const char *filter = nullptr;
+
+// keep a value alive, so that the work making it is not optimized away
+static volatile int sink;
+
+// run body(n) with growing n until it takes long enough, then report
+// the cost of one of the ops operations it does per unit of n
+template <typename Body>
+static void measure(const char *bench, const std::string &name, const char *unit,
+                    long long opsPerRound, Body body) {
+    if (filter != nullptr && std::strstr(bench, filter) == nullptr)
+        return;
+
+    typedef std::chrono::steady_clock Clock;
+    long long rounds = 1;
+    for (;;) {
+        long long before = allocations;
+        Clock::time_point start = Clock::now();
+        body(rounds);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        long long allocs = allocations - before;
+
+        if (seconds >= MIN_TIME || rounds >= (1LL << 40)) {
+            double ops = double(rounds) * opsPerRound;
+            std::cout << "{\"bench\": \"" << bench << "\", \"case\": \"" << name
+                      << "\", \"unit\": \"" << unit << "\", \"ops\": " << (long long)ops
+                      << ", \"seconds\": " << seconds
+                      << ", \"ns_per_op\": " << seconds * 1e9 / ops
+                      << ", \"ops_per_sec\": " << ops / seconds
+                      << ", \"allocs_per_op\": " << allocs / ops << "}" << std::endl;
+            return;
+        }
+        rounds *= seconds > 0 ? std::max(2.0, MIN_TIME * 1.2 / seconds) : 10.0;
+    }
+}
+
+// an expression nested depth times in parentheses
+static std::string nested(int depth) {
+    std::string exp = "A";
+    for (int i = 0; i < depth; i++)
+        exp = "(" + exp + " + " + std::to_string(i) + ") * B";
+    return exp;
+}
+
+// a balanced sum of a constant and variables, with the given number of leaves
+static std::string balanced(int leaves) {
+    if (leaves == 1)
+        return "X";
+    return "(" + balanced(leaves / 2) + " + " + balanced(leaves - leaves / 2) + ")";
+}
+
+static void tokenizer() {
+    const std::vector<std::string> lines = {
+        "10 LET TOTAL = TOTAL + PRICE * (COUNT - 1) / 2",
+        "20 IF TOTAL > 10000 THEN 50",
+        "30 PRINT TOTAL ** 2 - 7",
+        "40 GOTO 10",
+        "50 REM done with the loop",
+    };
+    measure("tokenizer", "mixed lines", "line", lines.size(), [&](long long rounds) {
+        Tokenizer tokenizer("");
+        for (long long r = 0; r < rounds; r++) {
+            for (auto &line : lines) {
+                tokenizer.scan(line.data(), line.data() + line.size());
+                sink = tokenizer.tokens.size();
+            }
+        }
+    });
+}
+
+static void parser() {
+    const std::vector<std::pair<const char *, std::string>> expressions = {
+        {"shallow", "B + C * 2"},
+        {"nested 16", nested(16)},
+        {"nested 256", nested(256)},
+    };
+    for (auto &c : expressions) {
+        std::string line = "LET A = " + c.second;
+        Tokenizer tokenizer(line);
+        int end = tokenizer.tokens.size();
+        measure("expparser", c.first, "expression", 1, [&](long long rounds) {
+            Arena arena;
+            for (long long r = 0; r < rounds; r++) {
+                ExpParser parser(tokenizer, 3, end, arena);
+                sink = parser.expression != nullptr;
+            }
+        });
+    }
+
+    const std::vector<std::pair<const char *, std::string>> statements = {
+        {"let", "LET A = B + C * 2"},
+        {"if", "IF A + 1 < B * 2 THEN 100"},
+        {"nested 256", "PRINT " + nested(256)},
+    };
+    for (auto &c : statements) {
+        Tokenizer tokenizer(c.second);
+        measure("stmtparser", c.first, "statement", 1, [&](long long rounds) {
+            Arena arena;
+            for (long long r = 0; r < rounds; r++) {
+                StmtParser parser(tokenizer, 0, arena);
+                sink = parser.statement != nullptr;
+            }
+        });
+    }
+}
+
+static void eval() {
+    for (int leaves : {2, 64, 4096}) {
+        std::string line = "LET A = " + balanced(leaves);
+        Tokenizer tokenizer(line);
+        Arena arena;
+        ExpParser parser(tokenizer, 3, tokenizer.tokens.size(), arena);
+        EvaluationContext context;
+        context.setValue("X", 3);
+        parser.expression->resolve(context);
+
+        int nodes = 2 * leaves - 1;
+        measure("eval", std::to_string(nodes) + " nodes", "node", nodes, [&](long long rounds) {
+            for (long long r = 0; r < rounds; r++)
+                sink = parser.expression->eval(context);
+        });
+    }
+}
+
+static void context() {
+    for (int size : {10, 1000, 100000}) {
+        EvaluationContext context;
+        std::vector<std::string> names;
+        for (int i = 0; i < size; i++) {
+            names.push_back("V" + std::to_string(i));
+            context.setValue(names.back(), i);
+        }
+        const int probes = 1024;
+        std::vector<int> slots;
+        for (int i = 0; i < probes; i++)
+            slots.push_back(context.slot(names[(i * 7919LL) % size]));
+
+        std::string name = std::to_string(size) + " variables";
+        measure("context.name", name, "lookup", probes, [&](long long rounds) {
+            int sum = 0;
+            for (long long r = 0; r < rounds; r++)
+                for (int i = 0; i < probes; i++)
+                    sum += context.getValue(names[(i * 7919LL) % size]);
+            sink = sum;
+        });
+        measure("context.slot", name, "lookup", probes, [&](long long rounds) {
+            int sum = 0;
+            for (long long r = 0; r < rounds; r++)
+                for (int slot : slots)
+                    sum += context.getValue(slot);
+            sink = sum;
+        });
+    }
+}
+
+// load a program from its text
+static void load(Program &program, const std::string &text) {
+    Loader loader(text.data(), text.data() + text.size(), &program);
+}
+
+static void program() {
+    // three statements a loop, with the loop bound given by N
+    const std::string loop =
+        "10 LET I = 0\n"
+        "20 LET S = 0\n"
+        "30 LET S = S + I * 3 - I / 2\n"
+        "40 LET I = I + 1\n"
+        "50 IF I < N THEN 30\n"
+        "60 END\n";
+    const long long iterations = 100000;
+    measure("program.run", "loop", "statement", 3 * iterations, [&](long long rounds) {
+        Program program;
+        load(program, loop);
+        program.setVariable("N", iterations);
+        std::string out, var;
+        for (long long r = 0; r < rounds; r++)
+            program.run(out, var);
+    });
+
+    Arena arena;
+    std::string let = "LET S = S + I * 3 - I / 2";
+    Tokenizer tokenizer(let);
+    StmtParser parser(tokenizer, 0, arena);
+    measure("program.step", "let", "statement", 1, [&](long long rounds) {
+        Program program;
+        program.setVariable("S", 0);
+        program.setVariable("I", 1);
+        std::string out;
+        for (long long r = 0; r < rounds; r++)
+            program.step(out, parser.statement);
+    });
+}
+
+static void cache() {
+    // a long program run once through, as a script loaded to be run
+    std::ostringstream ost;
+    const int lines = 20000;
+    for (int i = 1; i <= lines; i++)
+        ost << i << (i % 4 == 0 ? " IF S > 1000000 THEN " + std::to_string(i + 1)
+                                : " LET S = S + I * " + std::to_string(i % 97) + " - I / 2") << "\n";
+    ost << lines + 1 << " END\n";
+    const std::string text = ost.str(), path = "qbasic-bench.basc";
+    const char *begin = text.data(), *end = begin + text.size();
+    std::string out, var;
+
+    measure("cache", "parse", "line", lines, [&](long long rounds) {
+        for (long long r = 0; r < rounds; r++) {
+            Program program;
+            Loader loader(begin, end, &program);
+            program.setVariable("I", 1);
+            program.setVariable("S", 0);
+            program.run(out, var);
+        }
+    });
+    { Program program; Cache cache(begin, end, path, &program); }
+    measure("cache", "hit", "line", lines, [&](long long rounds) {
+        for (long long r = 0; r < rounds; r++) {
+            Program program;
+            Cache cache(begin, end, path, &program);
+            sink = cache.hit;
+            program.setVariable("I", 1);
+            program.setVariable("S", 0);
+            program.run(out, var);
+        }
+    });
+    std::remove(path.c_str());
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 2) {
+        std::cerr << "usage: qbasic-bench [name]" << std::endl;
+        return 2;
+    }
+    if (argc == 2)
+        filter = argv[1];
+
+    try {
+        tokenizer();
+        parser();
+        eval();
+        context();
+        program();
+        cache();
+    } catch (ParseException &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    } catch (RuntimeException &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
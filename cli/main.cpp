@@ -0,0 +1,383 @@
+#include "program.h"
+#include "parser.h"
+#include "loader.h"
+#include "mappedfile.h"
+#include "transpiler.h"
+#include "batch.h"
+#include "jobrunner.h"
+#include "checkpoint.h"
+#include "cache.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#define isatty _isatty
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+
+/*
+ * A command line runner without any GUI.
+ * It loads a program from a file, reads INPUT values from stdin
+ * and writes PRINT output to stdout.  Errors go to stderr.
+ * With --profile, a report of the slowest lines follows on stderr.
+ * With --trace, the last lines entered, jumps, values printed and
+ * waits for INPUT of the run are written to a file in the Chrome
+ * trace event format, to be opened by chrome://tracing or Perfetto.
+ * With --emit-c or --native, the program is not run but translated
+ * into C, and with --native also built by the compiler in $CC or cc.
+ * With --batch, it runs once for each line of INPUT values in a file,
+ * all runs at once, and prints the output of each after a `== n` line.
+ * With --jobs, it reads a list of jobs, one program file followed by
+ * its INPUT values on each line, and runs them all on every core.
+ * With --checkpoint, the state of the run is saved to a file now and
+ * then, on SIGINT or SIGTERM, and when INPUT finds nothing on stdin,
+ * and --resume goes on from such a file instead of a program file.
+ * Programs are loaded through a compiled cache next to the program
+ * file, a.basc for a.basic, unless --no-cache is given.
+ * Reads of variables which may not be set yet and lines which are
+ * never reached are reported on stderr once the program is loaded.
+ * With --max-steps, --max-time and --max-memory, a run, each job or
+ * each lane of a batch stops with a runtime error after that many
+ * bytecode instructions, milliseconds spent running, or bytes of
+ * variables; the exit code of a single run is then 3.
+ */
+
+/* backward jumps between two looks at the clock and signals */
+static const long long SLICE = 1 << 20;
+
+/* seconds between two checkpoints of a long run */
+static const int SAVE_INTERVAL = 10;
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+static void interrupt(int)
+{
+    interrupted = 1;
+}
+
+static int usage()
+{
+    std::cerr << "usage: qbasic [--profile] [--trace <out.json>] [--no-cache] [--checkpoint <state>] [limits] <file.basic>\n"
+                 "       qbasic [--profile] [--trace <out.json>] [--checkpoint <state>] [limits] --resume <state>\n"
+                 "       qbasic --emit-c <out.c> <file.basic>\n"
+                 "       qbasic --native <out> <file.basic>\n"
+                 "       qbasic [limits] --batch <inputs> <file.basic>\n"
+                 "       qbasic [limits] --jobs <list>\n"
+                 "limits: --max-steps <n> --max-time <ms> --max-memory <bytes>" << std::endl;
+    return 2;
+}
+
+// a positive number given to an option, or 0 if it is not one
+static long long count(const char *arg)
+{
+    char *end;
+    long long n = std::strtoll(arg, &end, 10);
+    return *end == '\0' && n > 0 ? n : 0;
+}
+
+// write what has been printed so far
+static void flush(std::string &out)
+{
+    if (out.empty())
+        return;
+    std::cout << out << '\n';
+    out.clear();
+}
+
+// write the state of a run, replacing the old file only once written
+static void save(Program &program, const std::string &path, const std::string &input)
+{
+    Checkpoint checkpoint(program, input);
+    std::string temp = path + ".tmp";
+    std::ofstream ofs(temp, std::ios::binary);
+    ofs << checkpoint.data;
+    ofs.close();
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    if (!ofs || std::rename(temp.c_str(), path.c_str()) != 0)
+        throw RuntimeException("cannot write " + path);
+}
+
+// give a variable the next value on stdin
+static void answer(Program &program, const std::string &var, const char *state)
+{
+    if (isatty(fileno(stdin)))
+        std::cerr << var << " ? " << std::flush;
+    int n = 0;
+    if (!(std::cin >> n)) {
+        if (state != nullptr)
+            save(program, state, var);
+        throw RuntimeException("no input for `" + var + "`");
+    }
+    program.setVariable(var, n);
+}
+
+// run the program to its end, answering INPUT from stdin,
+// and going on after the input of var if it waits for one
+static int execute(Program &program, const char *state, std::string var)
+{
+    bool skip = false;
+    if (!var.empty()) {
+        answer(program, var, state);
+        skip = true;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point saved = Clock::now();
+    std::string out;
+    for (;;) {
+        ProgramState ret;
+        try {
+            ret = program.run(out, var, skip, state != nullptr ? SLICE : 0);
+        } catch (RuntimeException &) {
+            flush(out);
+            throw;
+        }
+        flush(out);
+        skip = false;
+
+        if (ret == RUNNING) {
+            // only runs with a checkpoint are cut into slices
+            if (interrupted) {
+                save(program, state, "");
+                std::cerr << "interrupted, saved to " << state << std::endl;
+                return 130;
+            }
+            if (Clock::now() - saved >= std::chrono::seconds(SAVE_INTERVAL)) {
+                save(program, state, "");
+                saved = Clock::now();
+            }
+            continue;
+        }
+        if (ret != INPUTTING) {
+            // a finished run is not to be resumed
+            if (state != nullptr)
+                std::remove(state);
+            return 0;
+        }
+
+        answer(program, var, state);
+        skip = true;
+    }
+}
+
+// write the program as C, and build it into an executable if asked
+static int translate(Program &program, std::string source, const char *native)
+{
+    Transpiler transpiler(program);
+    std::ofstream ofs(source);
+    ofs << transpiler.source;
+    ofs.close();
+    if (!ofs) {
+        std::cerr << "cannot write " << source << std::endl;
+        return 2;
+    }
+    if (native == nullptr)
+        return 0;
+
+    const char *cc = std::getenv("CC");
+    std::string command = std::string(cc != nullptr && *cc != '\0' ? cc : "cc")
+            + " -O2 -o \"" + native + "\" \"" + source + "\"";
+    if (std::system(command.c_str()) != 0) {
+        std::cerr << "failed to build " << native << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// run the program for every line of input values, in lanes
+static int batch(Program &program, const char *path, const Limits &limits)
+{
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) {
+        std::cerr << "cannot open " << path << std::endl;
+        return 2;
+    }
+    std::vector<std::vector<int>> inputs;
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::istringstream ist(line);
+        inputs.emplace_back();
+        for (int n; ist >> n;)
+            inputs.back().push_back(n);
+    }
+
+    Batch runs(program, inputs, limits);
+    for (std::size_t i = 0; i < inputs.size(); i++) {
+        std::cout << "== " << i + 1 << '\n' << runs.outputs[i];
+        if (!runs.errors[i].empty())
+            std::cout << runs.errors[i] << '\n';
+    }
+    std::cout.flush();
+    std::cerr << "lanes: " << inputs.size() << ", groups: " << runs.groups
+              << ", utilization: " << runs.utilization() * 100 << "%" << std::endl;
+    return 0;
+}
+
+// run every job in a list, each line a program file and its inputs
+static int jobs(const char *path, const Limits &limits)
+{
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) {
+        std::cerr << "cannot open " << path << std::endl;
+        return 2;
+    }
+    std::vector<Job> jobs;
+    std::map<std::string, std::string> sources;
+    std::string line, name;
+    while (std::getline(ifs, line)) {
+        std::istringstream ist(line);
+        if (!(ist >> name))
+            continue;
+        auto it = sources.find(name);
+        if (it == sources.end()) {
+            MappedFile file(name);
+            if (!file.isOpen()) {
+                std::cerr << "cannot open " << name << std::endl;
+                return 2;
+            }
+            it = sources.emplace(name, std::string(file.data(), file.size())).first;
+        }
+        jobs.push_back(Job{it->second, {}});
+        for (int n; ist >> n;)
+            jobs.back().inputs.push_back(n);
+    }
+
+    JobRunner runs(jobs, 0, limits);
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        std::cout << "== " << i + 1 << '\n' << runs.outputs[i];
+        if (!runs.errors[i].empty())
+            std::cout << runs.errors[i] << '\n';
+    }
+    std::cout.flush();
+    std::cerr << "jobs: " << jobs.size() << ", programs: " << runs.programs << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    bool profile = false, cache = true;
+    const char *path = nullptr, *emit = nullptr, *native = nullptr, *inputs = nullptr, *list = nullptr;
+    const char *state = nullptr, *resume = nullptr, *trace = nullptr;
+    Limits limits = Limits();
+    bool limited = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--profile")
+            profile = true;
+        else if (arg == "--trace" && i + 1 < argc && !trace)
+            trace = argv[++i];
+        else if (arg == "--no-cache")
+            cache = false;
+        else if (arg == "--emit-c" && i + 1 < argc && !emit && !native && !inputs)
+            emit = argv[++i];
+        else if (arg == "--native" && i + 1 < argc && !emit && !native && !inputs)
+            native = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc && !emit && !native && !inputs)
+            inputs = argv[++i];
+        else if (arg == "--jobs" && i + 1 < argc && !list)
+            list = argv[++i];
+        else if (arg == "--checkpoint" && i + 1 < argc && !state)
+            state = argv[++i];
+        else if (arg == "--resume" && i + 1 < argc && !resume)
+            resume = argv[++i];
+        else if (arg == "--max-steps" && i + 1 < argc && (limits.steps = count(argv[++i])) > 0)
+            limited = true;
+        else if (arg == "--max-time" && i + 1 < argc && (limits.millis = count(argv[++i])) > 0)
+            limited = true;
+        else if (arg == "--max-memory" && i + 1 < argc && (limits.bytes = count(argv[++i])) > 0)
+            limited = true;
+        else if (path == nullptr && arg.compare(0, 2, "--") != 0)
+            path = argv[i];
+        else
+            return usage();
+    }
+    if (list != nullptr) {
+        if (path != nullptr || profile || trace || !cache || emit || native || inputs || state || resume)
+            return usage();
+        std::ios::sync_with_stdio(false);
+        return jobs(list, limits);
+    }
+    if ((path == nullptr) == (resume == nullptr) || ((state || trace) && (emit || native || inputs)) || (limited && (emit || native)))
+        return usage();
+    if (resume != nullptr)
+        path = resume;
+
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        std::cerr << "cannot open " << path << std::endl;
+        return 2;
+    }
+
+    std::ios::sync_with_stdio(false);
+
+    Program program;
+    program.setProfiling(profile);
+    program.setRecording(trace != nullptr);
+    program.setLimits(limits);
+    int ret = 0;
+    try {
+        std::string var;
+        if (resume != nullptr) {
+            Checkpoint checkpoint(file.data(), file.data() + file.size());
+            checkpoint.restore(&program);
+            var = checkpoint.input;
+        } else if (cache) {
+            Cache cached(file.data(), file.data() + file.size(), Cache::pathOf(path), &program);
+        } else {
+            Loader loader(file.data(), file.data() + file.size(), &program);
+        }
+        if (resume == nullptr)
+            for (auto &warning : program.warnings())
+                std::cerr << warning << "\n";
+        if (emit != nullptr)
+            return translate(program, emit, nullptr);
+        if (native != nullptr)
+            return translate(program, std::string(native) + ".c", native);
+        if (inputs != nullptr)
+            return batch(program, inputs, limits);
+        if (state != nullptr) {
+            std::signal(SIGINT, interrupt);
+            std::signal(SIGTERM, interrupt);
+        }
+        ret = execute(program, state, var);
+    } catch (ParseException &e) {
+        std::cout.flush();
+        std::cerr << e.what() << std::endl;
+        return 1;
+    } catch (LimitException &e) {
+        std::cout.flush();
+        std::cerr << e.what() << std::endl;
+        ret = 3;
+    } catch (RuntimeException &e) {
+        std::cout.flush();
+        std::cerr << e.what() << std::endl;
+        ret = 1;
+    }
+
+    if (profile) {
+        std::cout.flush();
+        std::cerr << program.toProfile(true);
+    }
+    if (trace != nullptr) {
+        std::ofstream ofs(trace);
+        ofs << program.toTrace();
+        ofs.close();
+        if (!ofs) {
+            std::cerr << "cannot write " << trace << std::endl;
+            return 2;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,39 @@
+#include "arena.h"
+
+#include <cstdint>
+#include <cstring>
+
+Arena::Arena(std::size_t blockSize):
+    blockSize(blockSize),
+    next(nullptr),
+    end(nullptr),
+    bytes(0) {
+
+}
+
+Arena::~Arena() {
+    for (auto chunk : chunks)
+        delete[] chunk;
+}
+
+void *Arena::allocate(std::size_t size, std::size_t align) {
+    std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(next) + align - 1) & ~(std::uintptr_t)(align - 1);
+    if (next == nullptr || p + size > reinterpret_cast<std::uintptr_t>(end)) {
+        // start a new block, a bigger one if the object does not fit
+        std::size_t n = size + align > blockSize ? size + align : blockSize;
+        chunks.push_back(new char[n]);
+        next = chunks.back();
+        end = next + n;
+        p = (reinterpret_cast<std::uintptr_t>(next) + align - 1) & ~(std::uintptr_t)(align - 1);
+    }
+    next = reinterpret_cast<char *>(p + size);
+    bytes += size;
+    return reinterpret_cast<void *>(p);
+}
+
+const char *Arena::copy(const char *str, std::size_t length) {
+    char *ret = static_cast<char *>(allocate(length + 1, 1));
+    std::memcpy(ret, str, length);
+    ret[length] = '\0';
+    return ret;
+}
@@ -0,0 +1,59 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Class: Arena
+ * -----------------
+ * This class is a bump allocator.  Memory is handed out from
+ * large blocks, one after another, and is only given back all at
+ * once when the arena is destroyed.  Objects made in an arena are
+ * never destructed, so they must not own any other resource:
+ * they can only refer to memory of the same arena.
+ */
+
+class Arena {
+
+public:
+
+    Arena(std::size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    // raw memory, aligned as asked
+    void *allocate(std::size_t size, std::size_t align);
+
+    // construct an object in the arena
+    template <typename T, typename... Args>
+    T *make(Args &&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "objects in an arena are never destructed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // copy a string into the arena, with a terminating '\0'
+    const char *copy(const char *str, std::size_t length);
+    const char *copy(const std::string &str) {return copy(str.data(), str.size());}
+
+    /* statistics */
+    std::size_t blocks() const {return chunks.size();}
+    std::size_t used() const {return bytes;}
+
+private:
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    std::size_t blockSize;
+    std::vector<char *> chunks;
+    char *next, *end;
+    std::size_t bytes;
+
+};
+
+#endif // ARENA_H
@@ -0,0 +1,306 @@
+#include "batch.h"
+#include "dataflow.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+
+typedef std::chrono::steady_clock Clock;
+
+/* groups run between two looks at the clock, under a time limit */
+static const long long PERIOD = 1 << 10;
+
+/*
+ * The loops over lanes are marked `omp simd`, which core.pro turns
+ * on with -fopenmp-simd: they are vectorized at -O2 already, without
+ * the OpenMP runtime.  Loops which call fail() or build strings stay
+ * scalar, and only run lane by lane once a vector check finds a lane
+ * that needs them.
+ */
+
+// second = op(top, second) for all lanes, the operands never overlap
+template <typename Op>
+static inline void apply(int n, const int *__restrict top, int *__restrict second, Op op) {
+#pragma omp simd
+    for (int l = 0; l < n; l++)
+        second[l] = op(top[l], second[l]);
+}
+
+// v = top and mark defined in the lanes of the mask
+static inline void store(int n, const unsigned char *__restrict m, const int *__restrict top,
+                         int *__restrict v, unsigned char *__restrict d) {
+#pragma omp simd
+    for (int l = 0; l < n; l++) {
+        // both loaded first, a load under the condition would not vectorize
+        int value = top[l], old = v[l];
+        v[l] = m[l] ? value : old;
+        d[l] |= m[l];
+    }
+}
+
+// at = target in the lanes of the mask
+static inline void move(int n, const unsigned char *__restrict m, int *__restrict at, int target) {
+#pragma omp simd
+    for (int l = 0; l < n; l++)
+        at[l] = m[l] ? target : at[l];
+}
+
+// at = target where cmp(second, top) holds, the next line where it
+// does not, in the lanes of the mask
+template <typename Cmp>
+static inline void branch(int n, const unsigned char *__restrict m, const int *__restrict top,
+                          const int *__restrict second, int *__restrict at, int target, int next, Cmp cmp) {
+#pragma omp simd
+    for (int l = 0; l < n; l++) {
+        int to = cmp(second[l], top[l]) ? target : next;
+        at[l] = m[l] ? to : at[l];
+    }
+}
+
+// whether a lane of the mask has a flag not set
+static inline bool any(int n, const unsigned char *__restrict m, const unsigned char *__restrict set) {
+    unsigned char found = 0;
+#pragma omp simd reduction(|:found)
+    for (int l = 0; l < n; l++)
+        found |= m[l] & !set[l];
+    return found != 0;
+}
+
+Batch::Batch(Program &program, const std::vector<std::vector<int>> &inputs, const Limits &limits):
+    outputs(inputs.size()),
+    errors(inputs.size()),
+    groups(0),
+    laneSteps(0),
+    lanes(inputs.size()),
+    mask(inputs.size(), 0),
+    at(inputs.size(), 0) {
+    const EvaluationContext &context = program.variables();
+    Bytecode code(program.statements());
+    int count = code.starts.size();
+    if (lanes == 0 || count == 0)
+        return;
+    if (code.link() >= 0) {
+        for (int l = 0; l < lanes; l++)
+            fail(l, "no matching line number");
+        return;
+    }
+    if (limits.bytes > 0 && (long long)context.bytes() > limits.bytes) {
+        for (int l = 0; l < lanes; l++)
+            fail(l, "variables over the memory limit of " + std::to_string(limits.bytes) + " bytes");
+        return;
+    }
+    Dataflow(code, context).apply(code);
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(limits.millis);
+
+    // variables and the operand stack, one array of lanes each
+    int n = lanes, slots = context.size();
+    std::vector<int> values(slots * n);
+    std::vector<unsigned char> defined(slots * n);
+    for (int slot = 0; slot < slots; slot++) {
+        std::fill_n(values.begin() + slot * n, n, context.getValue(slot));
+        std::fill_n(defined.begin() + slot * n, n, context.isDefined(slot));
+    }
+    std::vector<int> stack((code.depth + 1) * n);
+    std::vector<std::size_t> next(n, 0); // next input of each lane
+    std::vector<unsigned char> nonzero(n); // lanes whose divisor is not 0
+    std::vector<int> exponents(n);
+    std::vector<long long> left(n, limits.steps); // instructions each lane may still run
+
+    for (;;) {
+        // the lowest line any lane is at runs next, for all lanes there
+        int line = INT_MAX;
+        const int *a = at.data();
+#pragma omp simd reduction(min:line)
+        for (int l = 0; l < n; l++) {
+            int to = a[l] < 0 ? INT_MAX : a[l];
+            line = to < line ? to : line;
+        }
+        if (line == INT_MAX)
+            return;
+        if (limits.millis > 0 && groups % PERIOD == 0 && Clock::now() >= deadline) {
+            for (int l = 0; l < n; l++)
+                if (at[l] >= 0)
+                    fail(l, "time limit of " + std::to_string(limits.millis) + " ms reached");
+            return;
+        }
+        unsigned char *m = mask.data();
+        int active = 0;
+#pragma omp simd reduction(+:active)
+        for (int l = 0; l < n; l++) {
+            m[l] = a[l] == line;
+            active += m[l];
+        }
+        groups++;
+        laneSteps += active;
+
+        int begin = code.starts[line];
+        int end = line + 1 < count ? code.starts[line + 1] : code.code.size();
+        int *sp = stack.data();
+        bool moved = false; // lanes have been sent elsewhere
+
+        int ip = begin;
+        for (; ip < end && !moved; ip++) {
+            const Instruction &i = code.code[ip];
+            int *top = sp - n, *second = sp - 2 * n;
+            bool slot = i.op == OP_LOAD || i.op == OP_LOAD_UNCHECKED || i.op == OP_STORE || i.op == OP_INPUT;
+            int *v = values.data() + (slot ? i.arg * n : 0);
+            unsigned char *d = defined.data() + (v - values.data());
+
+            switch (i.op) {
+            case OP_CONST:
+                std::fill_n(sp, n, i.arg);
+                sp += n;
+                break;
+            case OP_LOAD:
+                if (any(n, m, d))
+                    for (int l = 0; l < n; l++)
+                        if (m[l] && !d[l])
+                            fail(l, "`" + context.name(i.arg) + "` is not declared");
+                std::copy(v, v + n, sp);
+                sp += n;
+                break;
+            case OP_LOAD_UNCHECKED:
+                std::copy(v, v + n, sp);
+                sp += n;
+                break;
+            case OP_ADD:
+                apply(n, top, second, [](int a, int b) {return a + b;});
+                sp = top;
+                break;
+            case OP_SUB:
+                apply(n, top, second, [](int a, int b) {return a - b;});
+                sp = top;
+                break;
+            case OP_MUL:
+                apply(n, top, second, [](int a, int b) {return a * b;});
+                sp = top;
+                break;
+            case OP_DIV: {
+                unsigned char *z = nonzero.data();
+#pragma omp simd
+                for (int l = 0; l < n; l++)
+                    z[l] = second[l] != 0;
+                if (any(n, m, z))
+                    for (int l = 0; l < n; l++)
+                        if (m[l] && second[l] == 0)
+                            fail(l, "divide by zero");
+                // lanes not running may hold anything, they divide by 1;
+                // SIMD has no integer division, the quotients are scalar
+#pragma omp simd
+                for (int l = 0; l < n; l++)
+                    second[l] = m[l] ? second[l] : 1;
+                for (int l = 0; l < n; l++)
+                    second[l] = top[l] / second[l];
+                sp = top;
+                break;
+            }
+            case OP_POW: {
+                // squaring gives the same result as repeated products, modulo 2**32;
+                // all lanes take a bit of their exponents at a time, up to the
+                // highest bit of any, with the bases squared in place on the stack
+                int *e = exponents.data(), highest = 0;
+#pragma omp simd reduction(max:highest)
+                for (int l = 0; l < n; l++) {
+                    int x = second[l];
+                    e[l] = (m[l] != 0) & (x > 0) ? x : 0;
+                    second[l] = x < 0 ? 0 : 1;
+                    highest = e[l] > highest ? e[l] : highest;
+                }
+                for (int bit = 0; highest >> bit != 0; bit++) {
+#pragma omp simd
+                    for (int l = 0; l < n; l++) {
+                        unsigned base = top[l];
+                        second[l] = unsigned(second[l]) * (e[l] >> bit & 1 ? base : 1u);
+                        top[l] = base * base;
+                    }
+                }
+                sp = top;
+                break;
+            }
+            case OP_STORE:
+                store(n, m, top, v, d);
+                sp = top;
+                break;
+            case OP_PRINT:
+                for (int l = 0; l < n; l++)
+                    if (m[l])
+                        outputs[l] += std::to_string(top[l]) + "\n";
+                sp = top;
+                break;
+            case OP_INPUT:
+                for (int l = 0; l < n; l++) {
+                    if (!m[l])
+                        continue;
+                    if (next[l] >= inputs[l].size()) {
+                        fail(l, "no input for `" + context.name(i.arg) + "`");
+                        continue;
+                    }
+                    v[l] = inputs[l][next[l]++];
+                    d[l] = 1;
+                }
+                break;
+            case OP_GOTO:
+                move(n, m, at.data(), code.lineOf(i.arg));
+                moved = true;
+                break;
+            case OP_IFLT:
+                branch(n, m, top, second, at.data(), code.lineOf(i.arg), line + 1,
+                       [](int a, int b) {return a < b;});
+                sp = second;
+                moved = true;
+                break;
+            case OP_IFGT:
+                branch(n, m, top, second, at.data(), code.lineOf(i.arg), line + 1,
+                       [](int a, int b) {return a > b;});
+                sp = second;
+                moved = true;
+                break;
+            case OP_IFEQ:
+                branch(n, m, top, second, at.data(), code.lineOf(i.arg), line + 1,
+                       [](int a, int b) {return a == b;});
+                sp = second;
+                moved = true;
+                break;
+            case OP_END:
+                move(n, m, at.data(), -1);
+                moved = true;
+                break;
+            case OP_BREAK: // only ever patched into the code of a program
+                break;
+            }
+        }
+
+        // falling through to the next line
+        if (!moved)
+            move(n, m, at.data(), line + 1 < count ? line + 1 : -1);
+
+        // the instructions of the line are taken from every lane which ran
+        // it; a budget gone below 0 is told by its sign bit, as SIMD has
+        // no comparison of 64 bit integers before SSE4.2
+        if (limits.steps > 0) {
+            long long *budget = left.data(), ran = ip - begin;
+            unsigned long long over = 0;
+#pragma omp simd reduction(|:over)
+            for (int l = 0; l < n; l++) {
+                unsigned long long on = m[l];
+                long long rest = budget[l] - (long long)(ran & -on);
+                budget[l] = rest;
+                over |= (unsigned long long)rest >> 63 & on;
+            }
+            if (over)
+                for (int l = 0; l < n; l++)
+                    if (m[l] && budget[l] < 0)
+                        fail(l, "instruction limit of " + std::to_string(limits.steps) + " reached");
+        }
+    }
+}
+
+void Batch::fail(int lane, const std::string &err) {
+    errors[lane] = "runtime error: " + err;
+    mask[lane] = 0;
+    at[lane] = -1;
+}
+
+double Batch::utilization() const {
+    return groups == 0 ? 0 : double(laneSteps) / (double(groups) * lanes);
+}
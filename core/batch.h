@@ -0,0 +1,55 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "program.h"
+
+/*
+ * Class: Batch
+ * -----------------
+ * This class runs one program over many lists of INPUT values
+ * at once, one lane per list, as if it were run once for each.
+ * Every variable is kept as an array with one value per lane.
+ * Lanes at the same line run it together: the lowest line any
+ * lane is at goes first, with a mask of the lanes that are there,
+ * so that lanes which went different ways meet again.  The loops
+ * over lanes are plain and branch free, for the compiler to turn
+ * them into SIMD instructions.
+ * Under limits, a lane fails once the instructions it has run pass
+ * the steps allowed, as checked after every line, and all lanes left
+ * fail once the batch has run for longer than the time allowed.
+ */
+
+class Batch {
+
+public:
+
+    Batch(Program &program, const std::vector<std::vector<int>> &inputs, const Limits &limits = Limits());
+
+    /* what each lane has printed, one value per line,
+     * and the runtime error it stopped with, if any */
+    std::vector<std::string> outputs;
+    std::vector<std::string> errors;
+
+    /* statistics: lines run for groups of lanes, and lanes in them */
+    long long groups;
+    long long laneSteps;
+
+    // fraction of the lanes doing work in an average group
+    double utilization() const;
+
+private:
+
+    // stop a lane with an error
+    void fail(int lane, const std::string &err);
+
+    int lanes;
+    std::vector<unsigned char> mask;
+    // line each lane is at, or -1 when it is over
+    std::vector<int> at;
+
+};
+
+#endif // BATCH_H
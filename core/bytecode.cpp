@@ -0,0 +1,135 @@
+#include "bytecode.h"
+#include "optimizer.h"
+#include "program.h"
+
+#include <algorithm>
+
+Bytecode::Bytecode(const std::map<int, Statement *> &stmts):
+    depth(0),
+    scratch(4096) {
+    numbers.reserve(stmts.size());
+    starts.reserve(stmts.size());
+    for (auto &stmt : stmts) {
+        numbers.push_back(stmt.first);
+        starts.push_back(code.size());
+        compile(stmt.second);
+    }
+    // falling through the last line ends the program
+    emit(OP_END);
+}
+
+Bytecode::Bytecode():
+    depth(0),
+    scratch(4096) {
+
+}
+
+int Bytecode::find(int number) const {
+    auto it = std::lower_bound(numbers.begin(), numbers.end(), number);
+    if (it == numbers.end() || *it != number)
+        return -1;
+    return it - numbers.begin();
+}
+
+int Bytecode::lineOf(int ip) const {
+    auto it = std::upper_bound(starts.begin(), starts.end(), ip);
+    if (it == starts.begin())
+        return 0;
+    return (it - starts.begin()) - 1;
+}
+
+int Bytecode::link() {
+    int line = 0, size = code.size(), target;
+    for (int ip = 0; ip < size; ip++) {
+        while (line + 1 < (int)starts.size() && starts[line + 1] <= ip)
+            line++;
+        switch (code[ip].op) {
+        case OP_GOTO:
+        case OP_IFLT:
+        case OP_IFGT:
+        case OP_IFEQ:
+            target = find(code[ip].arg);
+            if (target < 0)
+                return line;
+            code[ip].arg = starts[target];
+            break;
+        default:
+            break;
+        }
+    }
+    return -1;
+}
+
+void Bytecode::emit(OpCode op, int arg) {
+    code.push_back({op, arg});
+}
+
+int Bytecode::compile(Expression *exp) {
+    int rhs, lhs;
+
+    switch (exp->type()) {
+    case CONSTANT:
+        emit(OP_CONST, exp->getConstantValue());
+        return 1;
+    case IDENTIFIER:
+        emit(OP_LOAD, exp->getSlot());
+        return 1;
+    case COMPOUND:
+        // the right operand is evaluated first, as CompoundExp::eval does
+        rhs = compile(exp->getRHS());
+        lhs = compile(exp->getLHS()) + 1;
+        switch (exp->getOperator()) {
+        case PLUS: emit(OP_ADD); break;
+        case MINUS: emit(OP_SUB); break;
+        case TIMES: emit(OP_MUL); break;
+        case DIVIDE: emit(OP_DIV); break;
+        case POWER: emit(OP_POW); break;
+        }
+        return std::max(rhs, lhs);
+    }
+    throw RuntimeException("illegal expression");
+}
+
+int Bytecode::optimize(Expression *exp) {
+    Optimizer optimizer(exp, scratch);
+    return compile(optimizer.expression);
+}
+
+void Bytecode::compile(Statement *stmt) {
+    int need = 0;
+
+    switch (stmt->type()) {
+    case REM:
+        break;
+    case LET:
+        need = optimize(stmt->getExpression());
+        emit(OP_STORE, stmt->getSlot());
+        break;
+    case PRINT:
+        need = optimize(stmt->getExpression());
+        emit(OP_PRINT);
+        break;
+    case INPUT:
+        emit(OP_INPUT, stmt->getSlot());
+        break;
+    case GOTO:
+        emit(OP_GOTO, stmt->getLineNumber());
+        break;
+    case IFTHEN:
+        need = optimize(stmt->getExpression());
+        need = std::max(need, optimize(stmt->getExpression1()) + 1);
+        switch (stmt->getOperator()) {
+        case LESS: emit(OP_IFLT, stmt->getLineNumber()); break;
+        case GREATER: emit(OP_IFGT, stmt->getLineNumber()); break;
+        case EQUAL: emit(OP_IFEQ, stmt->getLineNumber()); break;
+        }
+        break;
+    case END:
+        emit(OP_END);
+        break;
+    default:
+        throw RuntimeException("unknown statement");
+    }
+
+    depth = std::max(depth, need);
+}
@@ -0,0 +1,103 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "exp.h"
+#include "statement.h"
+
+/*
+ * Type: OpCode
+ * -----------------
+ * This enumerated type is used to describe the instructions
+ * of the stack machine.  Expressions leave their value on top
+ * of the operand stack; statements consume it.  Jumps take a
+ * line number when emitted, and an instruction index once linked.
+ */
+
+enum OpCode {
+    OP_CONST,   // push the constant arg
+    OP_LOAD,    // push the value of the variable in slot arg
+    OP_LOAD_UNCHECKED, // the same, with the variable known to be set
+    OP_ADD,     // pop lhs, pop rhs, push lhs + rhs
+    OP_SUB,     // pop lhs, pop rhs, push lhs - rhs
+    OP_MUL,     // pop lhs, pop rhs, push lhs * rhs
+    OP_DIV,     // pop lhs, pop rhs, push lhs / rhs
+    OP_POW,     // pop lhs, pop rhs, push lhs ** rhs
+    OP_STORE,   // pop a value into the variable in slot arg
+    OP_PRINT,   // pop a value and print it
+    OP_INPUT,   // stop and ask for the variable in slot arg
+    OP_GOTO,    // jump to arg
+    OP_IFLT,    // pop rhs, pop lhs, jump to arg if lhs < rhs
+    OP_IFGT,    // pop rhs, pop lhs, jump to arg if lhs > rhs
+    OP_IFEQ,    // pop rhs, pop lhs, jump to arg if lhs = rhs
+    OP_END,     // stop the program
+    OP_BREAK    // stop before the instruction patched over, to debug
+};
+
+/*
+ * Type: Instruction
+ * -----------------
+ * This type is used to define one instruction of the stack machine.
+ */
+
+struct Instruction {
+    OpCode op;
+    int arg;
+};
+
+/*
+ * Class: Bytecode
+ * -----------------
+ * This class is a flat, compiled form of a program.
+ * Every line is translated into a run of instructions,
+ * and the runs are laid out in the order of line numbers.
+ * Statements must have been resolved against the context
+ * the bytecode is going to run with.
+ */
+
+class Bytecode {
+
+public:
+
+    Bytecode(const std::map<int, Statement *> &stmts);
+    // an empty bytecode, for a reader to fill in
+    Bytecode();
+
+    // index of the line with the given number, -1 if not found
+    int find(int number) const;
+    // index of the line which the given instruction belongs to
+    int lineOf(int ip) const;
+
+    // resolve the targets of jumps to instruction indices,
+    // returns the index of a line jumping nowhere, or -1
+    int link();
+
+    std::vector<Instruction> code;
+
+    /* line table: numbers[i] starts at code[starts[i]] */
+    std::vector<int> numbers;
+    std::vector<int> starts;
+
+    /* maximum depth of the operand stack */
+    int depth;
+
+private:
+
+    /* compiling helpers */
+    void emit(OpCode op, int arg = 0);
+    // compile an expression, returns the stack depth it needs
+    int compile(Expression *exp);
+    // compile the simplified form of an expression
+    int optimize(Expression *exp);
+    void compile(Statement *stmt);
+
+    // simplified expressions are made here
+    Arena scratch;
+
+};
+
+#endif // BYTECODE_H
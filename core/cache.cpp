@@ -0,0 +1,438 @@
+#include "cache.h"
+#include "bytecode.h"
+#include "mappedfile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+/*
+ * Layout of a cache file, every field a 32 bit little endian word:
+ *
+ *   header   magic, version, source size (low, high), source hash
+ *            (low, high), number of lines, of nodes, of instructions,
+ *            size of strings, hash of what follows (low, high)
+ *   lines    number, statement type and four operands each
+ *   nodes    expression type with the operator in the second byte,
+ *            and two operands each, children first
+ *   code     the linked bytecode of the lines, an opcode and an
+ *            argument each, then where every line starts
+ *   strings  names and REM contents, each ending with '\0'
+ *
+ * Operands are values, line numbers, operators, indices of nodes,
+ * or offsets of strings, as the type tells.  A missing node is
+ * written as NONE, and makes the cache be taken as broken.  Variables
+ * in the code are offsets of their names too, since slots depend on
+ * the context loaded into; the code is left out, with no instruction,
+ * when a jump goes nowhere, and is then compiled before a run.
+ */
+
+namespace {
+
+const char MAGIC[4] = {'Q', 'B', 'S', 'C'};
+const std::uint32_t VERSION = 3;
+const std::uint32_t NONE = ~0u;
+
+/* thrown on the first record that does not make sense */
+struct Broken {};
+
+/* sizes of the parts, in words */
+const std::size_t HEADER = 12;
+const std::size_t LINE = 6;
+const std::size_t NODE = 3;
+const std::size_t INSTRUCTION = 2;
+
+// hash of some bytes, taken eight at a time
+std::uint64_t hash(const char *begin, const char *end) {
+    const std::uint64_t K = 0x9e3779b97f4a7c15ull;
+    std::uint64_t h = std::uint64_t(end - begin) * K;
+    const char *p = begin;
+    for (; end - p >= 8; p += 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ w) * K;
+        h ^= h >> 29;
+    }
+    std::uint64_t w = 0;
+    std::memcpy(&w, p, end - p);
+    h = (h ^ w) * K;
+    return h ^ h >> 32;
+}
+
+std::uint32_t word(const char *p) {
+    const unsigned char *q = reinterpret_cast<const unsigned char *>(p);
+    return q[0] | q[1] << 8 | q[2] << 16 | std::uint32_t(q[3]) << 24;
+}
+
+void putWord(std::string &data, std::uint32_t n) {
+    for (int i = 0; i < 4; i++)
+        data += char(n >> (8 * i) & 0xff);
+}
+
+/* flattens the lines of a program into the tables */
+struct Writer {
+    std::string lines, nodes, code, strings;
+    std::uint32_t count = 0, ops = 0;
+    // offset of every string written, so that each is written once
+    std::unordered_map<std::string, std::uint32_t> offsets;
+
+    std::uint32_t string(const std::string &s) {
+        auto it = offsets.emplace(s, strings.size());
+        if (it.second) {
+            strings += s;
+            strings += '\0';
+        }
+        return it.first->second;
+    }
+
+    std::uint32_t node(Expression *exp) {
+        if (exp == nullptr)
+            return NONE;
+        std::uint32_t type = exp->type(), a = 0, b = 0;
+        switch (exp->type()) {
+        case CONSTANT:
+            a = exp->getConstantValue();
+            break;
+        case IDENTIFIER:
+            a = string(exp->getIdentifierName());
+            break;
+        case COMPOUND:
+            type |= exp->getOperator() << 8;
+            a = node(exp->getLHS());
+            b = node(exp->getRHS());
+            break;
+        }
+        putWord(nodes, type);
+        putWord(nodes, a);
+        putWord(nodes, b);
+        return count++;
+    }
+
+    void line(int number, Statement *stmt) {
+        std::uint32_t a = 0, b = 0, c = 0, d = 0;
+        switch (stmt->type()) {
+        case REM:
+            a = string(stmt->getContent());
+            break;
+        case LET:
+            a = string(stmt->getIdentifierName());
+            b = node(stmt->getExpression());
+            break;
+        case PRINT:
+            a = node(stmt->getExpression());
+            break;
+        case INPUT:
+            a = string(stmt->getIdentifierName());
+            break;
+        case GOTO:
+            a = stmt->getLineNumber();
+            break;
+        case IFTHEN:
+            a = node(stmt->getExpression());
+            b = stmt->getOperator();
+            c = node(stmt->getExpression1());
+            d = stmt->getLineNumber();
+            break;
+        case END:
+            break;
+        }
+        putWord(lines, number);
+        putWord(lines, stmt->type());
+        putWord(lines, a);
+        putWord(lines, b);
+        putWord(lines, c);
+        putWord(lines, d);
+    }
+
+    void bytecode(const Bytecode &linked, const EvaluationContext &context) {
+        for (const Instruction &i : linked.code) {
+            bool variable = i.op == OP_LOAD || i.op == OP_STORE || i.op == OP_INPUT;
+            putWord(code, i.op);
+            putWord(code, variable ? string(context.name(i.arg)) : std::uint32_t(i.arg));
+        }
+        for (int start : linked.starts)
+            putWord(code, start);
+        ops = linked.code.size();
+    }
+};
+
+// write the cache of a program, replacing the old file only once written
+void write(Program *program, const std::string &path, std::uint64_t size, std::uint64_t key) {
+    Writer writer;
+    for (auto &stmt : program->statements())
+        writer.line(stmt.first, stmt.second);
+    // compiled once here, and handed to the program for its first run
+    Bytecode *linked = new Bytecode(program->statements());
+    if (linked->link() < 0) {
+        writer.bytecode(*linked, program->variables());
+        program->adopt(linked);
+    } else {
+        delete linked;
+    }
+
+    std::string data(MAGIC, sizeof(MAGIC));
+    putWord(data, VERSION);
+    putWord(data, size);
+    putWord(data, size >> 32);
+    putWord(data, key);
+    putWord(data, key >> 32);
+    putWord(data, program->statements().size());
+    putWord(data, writer.count);
+    putWord(data, writer.ops);
+    putWord(data, writer.strings.size());
+    std::string body = writer.lines + writer.nodes + writer.code + writer.strings;
+    std::uint64_t check = hash(body.data(), body.data() + body.size());
+    putWord(data, check);
+    putWord(data, check >> 32);
+    data += body;
+
+    // a cache that cannot be written is only missed next time
+    std::string temp = path + ".tmp";
+    std::ofstream ofs(temp, std::ios::binary);
+    ofs << data;
+    ofs.close();
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    if (!ofs || std::rename(temp.c_str(), path.c_str()) != 0)
+        std::remove(temp.c_str());
+}
+
+// the code of a cache, resolved against the context, or null if broken
+Bytecode *bytecode(const char *table, std::size_t ops, const std::vector<std::pair<int, Statement *>> &lines,
+                   const char *strings, std::size_t stringSize, const EvaluationContext &context) {
+    std::size_t count = lines.size();
+    const char *startTable = table + ops * INSTRUCTION * 4;
+    Bytecode *linked = new Bytecode;
+    linked->numbers.reserve(count);
+    linked->starts.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        std::uint32_t start = word(startTable + i * 4);
+        if (start >= ops || start < (i == 0 ? 0 : std::uint32_t(linked->starts.back()))) {
+            delete linked;
+            return nullptr;
+        }
+        linked->numbers.push_back(lines[i].first);
+        linked->starts.push_back(start);
+    }
+
+    // slots by name, and by the offset of the name once looked up
+    std::unordered_map<std::string, int> slots;
+    for (int slot = 0; slot < context.size(); slot++)
+        slots.emplace(context.name(slot), slot);
+    std::unordered_map<std::uint32_t, int> offsets;
+
+    // the stack must be empty wherever a line starts and at the end,
+    // and every jump go to the start of a line, for the machine to
+    // never go past its stack
+    linked->code.reserve(ops);
+    int depth = 0;
+    std::size_t line = 0;
+    bool bad = count == 0 || linked->starts[0] != 0;
+    for (std::size_t ip = 0; ip < ops && !bad; ip++) {
+        std::uint32_t op = word(table + ip * INSTRUCTION * 4), arg = word(table + ip * INSTRUCTION * 4 + 4);
+        for (; line < count && std::uint32_t(linked->starts[line]) == ip; line++)
+            bad = bad || depth != 0;
+        switch (op) {
+        case OP_CONST:
+            depth++;
+            break;
+        case OP_LOAD:
+        case OP_STORE:
+        case OP_INPUT:
+            depth += op == OP_LOAD ? 1 : op == OP_STORE ? -1 : 0;
+            if (arg >= stringSize) {
+                bad = true;
+            } else if (offsets.count(arg) == 0) {
+                auto slot = slots.find(strings + arg);
+                bad = bad || slot == slots.end();
+                if (slot != slots.end())
+                    offsets[arg] = slot->second;
+            }
+            if (!bad)
+                arg = offsets[arg];
+            break;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_POW:
+            // the first operand must be there as well
+            bad = bad || depth < 2;
+            depth--;
+            break;
+        case OP_PRINT:
+            depth--;
+            break;
+        case OP_IFLT:
+        case OP_IFGT:
+        case OP_IFEQ:
+            depth -= 2;
+            // fall through
+        case OP_GOTO:
+            bad = bad || !std::binary_search(linked->starts.begin(), linked->starts.end(), int(arg));
+            break;
+        case OP_END:
+            break;
+        default:
+            bad = true;
+            break;
+        }
+        bad = bad || depth < 0;
+        linked->depth = std::max(linked->depth, depth);
+        linked->code.push_back(Instruction{OpCode(op), int(arg)});
+    }
+    if (bad || depth != 0 || linked->code.back().op != OP_END) {
+        delete linked;
+        return nullptr;
+    }
+    return linked;
+}
+
+// build the lines of a cache made for the source, false if it is not
+bool read(const MappedFile &file, std::uint64_t size, std::uint64_t key, Program *program) {
+    const char *p = file.data();
+    std::size_t length = file.size();
+    if (length < HEADER * 4 || std::memcmp(p, MAGIC, sizeof(MAGIC)) != 0 || word(p + 4) != VERSION)
+        return false;
+    if (word(p + 8) != std::uint32_t(size) || word(p + 12) != std::uint32_t(size >> 32) ||
+        word(p + 16) != std::uint32_t(key) || word(p + 20) != std::uint32_t(key >> 32))
+        return false;
+    std::uint64_t lineCount = word(p + 24), nodeCount = word(p + 28), opCount = word(p + 32);
+    std::uint64_t stringSize = word(p + 36), codeSize = opCount > 0 ? opCount * INSTRUCTION + lineCount : 0;
+    if (length != (HEADER + lineCount * LINE + nodeCount * NODE + codeSize) * 4 + stringSize)
+        return false;
+    std::uint64_t check = hash(p + HEADER * 4, p + length);
+    if (word(p + 40) != std::uint32_t(check) || word(p + 44) != std::uint32_t(check >> 32))
+        return false;
+    const char *lineTable = p + HEADER * 4;
+    const char *nodeTable = lineTable + lineCount * LINE * 4;
+    const char *codeTable = nodeTable + nodeCount * NODE * 4;
+    const char *strings = codeTable + codeSize * 4;
+    if (stringSize > 0 && strings[stringSize - 1] != '\0')
+        return false;
+
+    // one arena for all, with the strings copied at once
+    Arena *arena = new Arena;
+    const char *pool = arena->copy(strings, stringSize);
+    std::vector<Expression *> exps(nodeCount);
+    std::vector<std::pair<int, Statement *>> lines;
+    lines.reserve(lineCount);
+    // a node made before, or a string in the pool
+    auto exp = [&](std::uint32_t i, std::size_t below) -> Expression * {
+        if (i >= below)
+            throw Broken();
+        return exps[i];
+    };
+    auto name = [&](std::uint32_t offset) -> const char * {
+        if (offset >= stringSize)
+            throw Broken();
+        return pool + offset;
+    };
+
+    try {
+        for (std::size_t i = 0; i < nodeCount; i++) {
+            const char *n = nodeTable + i * NODE * 4;
+            std::uint32_t type = word(n), a = word(n + 4), b = word(n + 8);
+            switch (type & 0xff) {
+            case CONSTANT:
+                exps[i] = arena->make<ConstantExp>(int(a));
+                break;
+            case IDENTIFIER:
+                exps[i] = arena->make<IdentifierExp>(name(a));
+                break;
+            case COMPOUND:
+                if (type >> 8 > POWER)
+                    throw Broken();
+                exps[i] = arena->make<CompoundExp>(Operator(type >> 8), exp(a, i), exp(b, i));
+                break;
+            default:
+                throw Broken();
+            }
+        }
+
+        int last = 0;
+        for (std::size_t i = 0; i < lineCount; i++) {
+            const char *l = lineTable + i * LINE * 4;
+            int number = word(l);
+            std::uint32_t a = word(l + 8), b = word(l + 12), c = word(l + 16), d = word(l + 20);
+            if (number <= last)
+                throw Broken();
+            last = number;
+            Statement *stmt;
+            switch (word(l + 4)) {
+            case REM:
+                stmt = arena->make<RemStmt>(name(a));
+                break;
+            case LET:
+                stmt = arena->make<LetStmt>(name(a), exp(b, nodeCount));
+                break;
+            case PRINT:
+                stmt = arena->make<PrintStmt>(exp(a, nodeCount));
+                break;
+            case INPUT:
+                stmt = arena->make<InputStmt>(name(a));
+                break;
+            case GOTO:
+                stmt = arena->make<GotoStmt>(int(a));
+                break;
+            case IFTHEN:
+                if (b > EQUAL)
+                    throw Broken();
+                stmt = arena->make<IfStmt>(exp(a, nodeCount), Comparator(b), exp(c, nodeCount), int(d));
+                break;
+            case END:
+                stmt = arena->make<EndStmt>();
+                break;
+            default:
+                throw Broken();
+            }
+            lines.emplace_back(number, stmt);
+        }
+    } catch (Broken &) {
+        delete arena;
+        return false;
+    }
+
+    // the code is only that of the lines when there were none before
+    bool empty = program->statements().empty();
+    std::vector<Arena *> arenas(1, arena);
+    program->insert(lines, arenas);
+    if (opCount > 0 && empty) {
+        Bytecode *linked = bytecode(codeTable, opCount, lines, strings, stringSize, program->variables());
+        if (linked != nullptr)
+            program->adopt(linked);
+    }
+    return true;
+}
+
+}
+
+Cache::Cache(const char *begin, const char *end, const std::string &path,
+             Program *program, const Loader::Progress &progress):
+    hit(false) {
+    std::uint64_t size = end - begin, key = hash(begin, end);
+    {
+        MappedFile file(path);
+        if (file.isOpen())
+            hit = read(file, size, key, program);
+    }
+    if (hit) {
+        if (progress)
+            progress(size, size);
+        return;
+    }
+
+    Loader loader(begin, end, program, progress);
+    write(program, path, size, key);
+}
+
+std::string Cache::pathOf(const std::string &source) {
+    static const std::string SUFFIX = ".basic";
+    if (source.size() > SUFFIX.size() && source.compare(source.size() - SUFFIX.size(), SUFFIX.size(), SUFFIX) == 0)
+        return source.substr(0, source.size() - SUFFIX.size()) + ".basc";
+    return source + ".basc";
+}
@@ -0,0 +1,38 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <string>
+
+#include "loader.h"
+#include "program.h"
+
+/*
+ * Class: Cache
+ * -----------------
+ * This class loads a program through a compiled cache file, which
+ * holds the syntax trees of all its lines, flattened into tables of
+ * fixed-size records, and their linked bytecode.  The cache is keyed
+ * by the size and a hash of the source, and is read in place from a
+ * mapping of the file, so a program seen before is loaded without
+ * tokenizing or parsing it, and runs without compiling it.
+ * A missing, stale or broken cache is ignored: the source is parsed
+ * by a Loader as usual, and the cache is written again for next time.
+ */
+
+class Cache {
+
+public:
+
+    // load the source into an empty program, through the cache at path
+    Cache(const char *begin, const char *end, const std::string &path,
+          Program *program, const Loader::Progress &progress = Loader::Progress());
+
+    // the cache file of a source file, e.g. a.basc for a.basic
+    static std::string pathOf(const std::string &source);
+
+    // whether the program has been loaded from the cache
+    bool hit;
+
+};
+
+#endif // CACHE_H
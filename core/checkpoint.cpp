@@ -0,0 +1,111 @@
+#include "checkpoint.h"
+#include "loader.h"
+#include "parser.h"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+/* first bytes of every checkpoint, and the version of the layout */
+static const char MAGIC[4] = {'Q', 'B', 'C', 'K'};
+static const std::uint32_t VERSION = 1;
+
+static void putInt(std::string &data, std::uint32_t n) {
+    for (int i = 0; i < 4; i++)
+        data += char(n >> (8 * i) & 0xff);
+}
+
+static void putString(std::string &data, const std::string &s) {
+    putInt(data, s.size());
+    data += s;
+}
+
+namespace {
+
+/* reads the binary form from the front, checking every length */
+struct Reader {
+    const char *p, *end;
+
+    void need(std::size_t n) {
+        if (std::size_t(end - p) < n)
+            throw ParseException("broken checkpoint");
+    }
+
+    std::uint32_t getInt() {
+        need(4);
+        std::uint32_t n = 0;
+        for (int i = 0; i < 4; i++)
+            n |= std::uint32_t((unsigned char)p[i]) << (8 * i);
+        p += 4;
+        return n;
+    }
+
+    std::string getString() {
+        std::uint32_t n = getInt();
+        need(n);
+        std::string s(p, n);
+        p += n;
+        return s;
+    }
+};
+
+}
+
+Checkpoint::Checkpoint(Program &program, const std::string &input):
+    input(input),
+    line(program.currentLine()) {
+    std::ostringstream ost;
+    for (auto &stmt : program.statements())
+        ost << stmt.first << " " << stmt.second->toString() << "\n";
+    text = ost.str();
+
+    // slots never assigned are made again as the text is parsed
+    const EvaluationContext &context = program.variables();
+    for (int slot = 0; slot < context.size(); slot++)
+        if (context.isDefined(slot))
+            variables.push_back(Variable{context.name(slot), context.getValue(slot)});
+
+    data.assign(MAGIC, sizeof(MAGIC));
+    putInt(data, VERSION);
+    putInt(data, line);
+    putString(data, input);
+    putString(data, text);
+    putInt(data, variables.size());
+    for (auto &var : variables) {
+        putString(data, var.name);
+        putInt(data, var.value);
+    }
+}
+
+Checkpoint::Checkpoint(const char *begin, const char *end):
+    data(begin, end) {
+    Reader reader{begin, end};
+    reader.need(sizeof(MAGIC));
+    if (std::memcmp(begin, MAGIC, sizeof(MAGIC)) != 0)
+        throw ParseException("not a checkpoint");
+    reader.p += sizeof(MAGIC);
+    if (reader.getInt() != VERSION)
+        throw ParseException("checkpoint of another version");
+
+    line = reader.getInt();
+    input = reader.getString();
+    text = reader.getString();
+    std::uint32_t count = reader.getInt();
+    for (std::uint32_t i = 0; i < count; i++) {
+        std::string name = reader.getString();
+        int value = reader.getInt();
+        variables.push_back(Variable{name, value});
+    }
+    if (reader.p != end)
+        throw ParseException("broken checkpoint");
+}
+
+void Checkpoint::restore(Program *program) const {
+    Loader loader(text.data(), text.data() + text.size(), program);
+    for (auto &var : variables)
+        program->setVariable(var.name, var.value);
+    if (program->statement(line) != nullptr)
+        program->setCurrentLine(line);
+    else if (!program->statements().empty())
+        throw ParseException("broken checkpoint");
+}
@@ -0,0 +1,50 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+
+#include "program.h"
+
+/*
+ * Class: Checkpoint
+ * -----------------
+ * This class saves the state of a program stopped during a run,
+ * at INPUT or between two slices, so that it can be restored in
+ * another process and go on from where it was.  The binary form
+ * holds the line to go on from, the variable waiting for input,
+ * the program text and the defined variables.  Integers are 32 bit
+ * little endian, strings are a length followed by the bytes.
+ */
+
+class Checkpoint {
+
+public:
+
+    // capture a program, which waits to input the variable named if any
+    Checkpoint(Program &program, const std::string &input = std::string());
+    // read the binary form, throws ParseException if it is broken
+    Checkpoint(const char *begin, const char *end);
+
+    // put the state into an empty program
+    void restore(Program *program) const;
+
+    // the binary form
+    std::string data;
+    // variable the program waits to input, empty if none
+    std::string input;
+
+private:
+
+    struct Variable {
+        std::string name;
+        int value;
+    };
+
+    int line;
+    std::string text;
+    std::vector<Variable> variables;
+
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,17 @@
+# Include this file to build against the core library.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+win32:CONFIG(release, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/release
+else:win32:CONFIG(debug, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/debug
+else: CORE_LIB_DIR = $$OUT_PWD/../core
+
+LIBS += -L$$CORE_LIB_DIR -lbasic
+
+# the loader parses on several threads
+CONFIG += thread
+
+win32-g++: PRE_TARGETDEPS += $$CORE_LIB_DIR/libbasic.a
+else:win32: PRE_TARGETDEPS += $$CORE_LIB_DIR/basic.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libbasic.a
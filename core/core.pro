@@ -0,0 +1,51 @@
+TEMPLATE = lib
+TARGET = basic
+
+CONFIG += staticlib c++11 thread
+CONFIG -= qt
+
+# the lane loops of batch.cpp are marked `omp simd`; this vectorizes
+# them at -O2 without linking the OpenMP runtime
+gcc|clang: QMAKE_CXXFLAGS += -fopenmp-simd
+
+SOURCES += \
+    arena.cpp \
+    batch.cpp \
+    bytecode.cpp \
+    cache.cpp \
+    checkpoint.cpp \
+    dataflow.cpp \
+    exp.cpp \
+    jobrunner.cpp \
+    loader.cpp \
+    mappedfile.cpp \
+    machine.cpp \
+    optimizer.cpp \
+    parser.cpp \
+    program.cpp \
+    recorder.cpp \
+    statement.cpp \
+    tokenizer.cpp \
+    trace.cpp \
+    transpiler.cpp
+
+HEADERS += \
+    arena.h \
+    batch.h \
+    bytecode.h \
+    cache.h \
+    checkpoint.h \
+    dataflow.h \
+    exp.h \
+    jobrunner.h \
+    loader.h \
+    mappedfile.h \
+    machine.h \
+    optimizer.h \
+    parser.h \
+    program.h \
+    recorder.h \
+    statement.h \
+    tokenizer.h \
+    trace.h \
+    transpiler.h
@@ -0,0 +1,128 @@
+#include "dataflow.h"
+
+#include <cstdint>
+
+/* most words of the sets of all blocks together */
+static const std::size_t MAX_WORDS = 1 << 22;
+
+static bool isJump(OpCode op) {
+    return op == OP_GOTO || op == OP_IFLT || op == OP_IFGT || op == OP_IFEQ;
+}
+
+Dataflow::Dataflow(const Bytecode &code, const EvaluationContext &context, int entry) {
+    int size = code.code.size(), lines = code.starts.size();
+    if (lines == 0)
+        return;
+    // a machine starting at no line only ends, and starts again from line 0
+    if (entry < 0 || entry >= lines)
+        entry = 0;
+
+    // blocks start at the entries, where jumps go and after jumps
+    std::vector<bool> leader(size, false);
+    leader[0] = leader[code.starts[entry]] = true;
+    for (int ip = 0; ip < size; ip++) {
+        const Instruction &i = code.code[ip];
+        if (isJump(i.op))
+            leader[i.arg] = true;
+        if ((isJump(i.op) || i.op == OP_END) && ip + 1 < size)
+            leader[ip + 1] = true;
+    }
+    std::vector<int> firsts, blockOf(size);
+    for (int ip = 0; ip < size; ip++) {
+        if (leader[ip])
+            firsts.push_back(ip);
+        blockOf[ip] = firsts.size() - 1;
+    }
+    int blocks = firsts.size();
+    firsts.push_back(size);
+
+    // the set of variables surely set at the start of every block
+    std::size_t words = (context.size() + 63) / 64;
+    bool sets = blocks * words <= MAX_WORDS;
+    std::vector<std::uint64_t> in(sets ? blocks * words : 0);
+    std::vector<std::uint64_t> out(words);
+    std::vector<bool> seen(blocks, false), queued(blocks, false);
+    // the run after END starts from line 0 with what the context has
+    // then, which is at least what it has now
+    int starts[2] = {blockOf[code.starts[entry]], 0};
+    std::vector<int> work;
+    for (int start : starts) {
+        if (seen[start])
+            continue;
+        for (int slot = 0; sets && slot < context.size(); slot++)
+            if (context.isDefined(slot))
+                in[start * words + slot / 64] |= std::uint64_t(1) << slot % 64;
+        work.push_back(start);
+        seen[start] = queued[start] = true;
+    }
+
+    auto set = [](std::uint64_t *bits, int slot) {
+        bits[slot / 64] |= std::uint64_t(1) << slot % 64;
+    };
+    while (!work.empty()) {
+        int b = work.back();
+        work.pop_back();
+        queued[b] = false;
+
+        // what is set at the end of the block
+        const Instruction &last = code.code[firsts[b + 1] - 1];
+        if (sets) {
+            std::copy(in.begin() + b * words, in.begin() + (b + 1) * words, out.begin());
+            for (int ip = firsts[b]; ip < firsts[b + 1]; ip++)
+                if (code.code[ip].op == OP_STORE || code.code[ip].op == OP_INPUT)
+                    set(out.data(), code.code[ip].arg);
+        }
+
+        // and where it may go from there
+        int next[2], count = 0;
+        if (isJump(last.op))
+            next[count++] = blockOf[last.arg];
+        if (last.op != OP_GOTO && last.op != OP_END && b + 1 < blocks)
+            next[count++] = b + 1;
+        for (int k = 0; k < count; k++) {
+            int s = next[k];
+            bool changed = !seen[s];
+            for (std::size_t w = 0; sets && w < words; w++) {
+                std::uint64_t &bits = in[s * words + w];
+                std::uint64_t meet = seen[s] ? bits & out[w] : out[w];
+                changed |= meet != bits;
+                bits = meet;
+            }
+            seen[s] = true;
+            if (changed && !queued[s]) {
+                queued[s] = true;
+                work.push_back(s);
+            }
+        }
+    }
+
+    // sort the loads of the blocks reached
+    for (int b = 0; sets && b < blocks; b++) {
+        if (!seen[b])
+            continue;
+        std::copy(in.begin() + b * words, in.begin() + (b + 1) * words, out.begin());
+        for (int ip = firsts[b]; ip < firsts[b + 1]; ip++) {
+            const Instruction &i = code.code[ip];
+            if (i.op == OP_LOAD || i.op == OP_LOAD_UNCHECKED) {
+                if (out[i.arg / 64] >> i.arg % 64 & 1)
+                    proven.push_back(ip);
+                else
+                    unproven.push_back(ip);
+            } else if (i.op == OP_STORE || i.op == OP_INPUT) {
+                set(out.data(), i.arg);
+            }
+        }
+    }
+
+    // lines with code of their own, the last one without the final END
+    for (int line = 0; line < lines; line++) {
+        int end = line + 1 < lines ? code.starts[line + 1] : size - 1;
+        if (code.starts[line] < end && !seen[blockOf[code.starts[line]]])
+            unreachable.push_back(line);
+    }
+}
+
+void Dataflow::apply(Bytecode &code) const {
+    for (int ip : proven)
+        code.code[ip].op = OP_LOAD_UNCHECKED;
+}
@@ -0,0 +1,44 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <vector>
+
+#include "bytecode.h"
+
+/*
+ * Class: Dataflow
+ * -----------------
+ * This class finds which variables are surely set wherever they
+ * are read, by following all the ways linked bytecode can go from
+ * an entry line, and from the first line, where the machine goes
+ * on after END.  The code is cut into blocks at the lines jumps go
+ * to and after jumps; a variable is set at the start of a block when
+ * it is set at the end of every block leading there.  Variables set
+ * in the context before the run count as set at both entries, and
+ * the context may only set more of them later, never fewer.
+ * Programs with too many blocks and variables for the sets to fit in
+ * a few megabytes are only searched for unreachable lines.
+ */
+
+class Dataflow {
+
+public:
+
+    // follow the code from the line at index entry, and from line 0
+    // where a machine goes on after END, with the variables defined
+    // in the context set already
+    Dataflow(const Bytecode &code, const EvaluationContext &context, int entry = 0);
+
+    // turn the loads proven to be set into unchecked ones
+    void apply(Bytecode &code) const;
+
+    // loads which are proven to be set, by instruction index
+    std::vector<int> proven;
+    // loads which may read a variable not set, by instruction index
+    std::vector<int> unproven;
+    // lines with code which can not be reached from the entry, by index
+    std::vector<int> unreachable;
+
+};
+
+#endif // DATAFLOW_H
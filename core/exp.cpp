@@ -0,0 +1,199 @@
+#include "exp.h"
+#include "program.h"
+#include <sstream>
+#include <iostream>
+
+ConstantExp::ConstantExp(int val):
+    value(val) {
+
+}
+
+int ConstantExp::eval(EvaluationContext &) {
+    return value;
+}
+
+std::string ConstantExp::toString() {
+    std::ostringstream ost;
+    ost << value;
+    return ost.str();
+}
+
+std::string ConstantExp::toTree(int level) {
+    std::string prefix(level * 4, ' ');
+    return prefix + toString() + "\n";
+}
+
+ExpressionType ConstantExp::type() {
+    return CONSTANT;
+}
+
+int ConstantExp::getConstantValue() {
+    return value;
+}
+
+IdentifierExp::IdentifierExp(const char *name):
+    name(name),
+    slot(-1) {
+
+}
+
+int IdentifierExp::eval(EvaluationContext &context) {
+    if (!context.isDefined(slot)) {
+        throw RuntimeException("`" + std::string(name) + "` is not declared");
+    }
+    return context.getValue(slot);
+}
+
+std::string IdentifierExp::toString() {
+    return name;
+}
+
+std::string IdentifierExp::toTree(int level) {
+    std::string prefix(level * 4, ' ');
+    return prefix + name + "\n";
+}
+
+ExpressionType IdentifierExp::type() {
+    return IDENTIFIER;
+}
+
+void IdentifierExp::resolve(EvaluationContext &context) {
+    slot = context.slot(name);
+}
+
+std::string IdentifierExp::getIdentifierName() {
+    return name;
+}
+
+int IdentifierExp::getSlot() {
+    return slot;
+}
+
+CompoundExp::CompoundExp(Operator op, Expression *lhs, Expression *rhs):
+    op(op),
+    lhs(lhs),
+    rhs(rhs) {
+
+}
+
+std::string CompoundExp::name(Operator op) {
+    switch (op) {
+    case PLUS: return "+";
+    case MINUS: return "-";
+    case TIMES: return "*";
+    case DIVIDE: return "/";
+    case POWER: return "**";
+    }
+    return "";
+}
+
+int CompoundExp::apply(Operator op, int left, int right) {
+    switch (op) {
+    case PLUS: return left + right;
+    case MINUS: return left - right;
+    case TIMES: return left * right;
+    case DIVIDE:
+        if (right == 0)
+            throw RuntimeException("divide by zero");
+        return left / right;
+    case POWER:
+        return power(left, right);
+    }
+    throw RuntimeException("illegal operator in expression");
+    return 0;
+}
+
+int CompoundExp::power(int base, int exponent) {
+    if (exponent < 0)
+        return 0;
+    // squaring gives the same result as repeated products, modulo 2**32
+    unsigned b = base, ret = 1;
+    for (; exponent > 0; exponent >>= 1) {
+        if (exponent & 1)
+            ret *= b;
+        b *= b;
+    }
+    return ret;
+}
+
+int CompoundExp::eval(EvaluationContext &context) {
+    int right = rhs->eval(context);
+    int left = lhs->eval(context);
+    return apply(op, left, right);
+}
+
+std::string CompoundExp::toString() {
+    std::string ret = "(";
+    if (lhs)
+        ret += lhs->toString();
+    ret += " ";
+    ret += name(op);
+    ret += " ";
+    if (rhs)
+        ret += rhs->toString();
+    return ret + ")";
+}
+
+std::string CompoundExp::toTree(int level) {
+    std::string prefix(level * 4, ' ');
+    std::string ret = prefix + name(op) + "\n";
+    if (lhs)
+        ret += lhs->toTree(level + 1);
+    if (rhs)
+        ret += rhs->toTree(level + 1);
+    return ret;
+}
+
+ExpressionType CompoundExp::type() {
+    return COMPOUND;
+}
+
+void CompoundExp::resolve(EvaluationContext &context) {
+    lhs->resolve(context);
+    rhs->resolve(context);
+}
+
+Operator CompoundExp::getOperator() {
+    return op;
+}
+
+Expression *CompoundExp::getLHS() {
+    return lhs;
+}
+
+Expression *CompoundExp::getRHS() {
+    return rhs;
+}
+
+void EvaluationContext::setValue(const std::string &var, int value) {
+    setValue(slot(var), value);
+}
+
+int EvaluationContext::getValue(const std::string &var) {
+    auto it = symbolTable.find(var);
+    return it == symbolTable.end() ? 0 : values[it->second];
+}
+
+bool EvaluationContext::isDefined(const std::string &var) {
+    auto it = symbolTable.find(var);
+    return it != symbolTable.end() && defined[it->second];
+}
+
+int EvaluationContext::slot(const std::string &var) {
+    auto it = symbolTable.find(var);
+    if (it != symbolTable.end())
+        return it->second;
+    names.push_back(var);
+    values.push_back(0);
+    defined.push_back(false);
+    symbolTable.emplace(var, names.size() - 1);
+    return names.size() - 1;
+}
+
+std::size_t EvaluationContext::bytes() const {
+    // every name is kept twice, by slot and in a node of the table
+    std::size_t total = 0;
+    for (auto &name : names)
+        total += 2 * (sizeof(std::string) + name.size()) + sizeof(int) + 4 * sizeof(void *);
+    return total + values.capacity() * sizeof(int) + defined.capacity() / 8;
+}
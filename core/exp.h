@@ -9,6 +9,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 /* Forward reference */
 
@@ -23,6 +24,15 @@ class EvaluationContext;
 
 enum ExpressionType { CONSTANT, IDENTIFIER, COMPOUND };
 
+/*
+ * Type: Operator
+ * --------------------
+ * This enumerated type is used to differentiate the five arithmetic
+ * operators of compound expressions: +, -, *, / and **.
+ */
+
+enum Operator { PLUS, MINUS, TIMES, DIVIDE, POWER };
+
 /*
  * Class: Expression
  * -----------------
@@ -30,6 +40,7 @@ enum ExpressionType { CONSTANT, IDENTIFIER, COMPOUND };
  * Expression itself is an abstract class.  Every Expression object
  * is therefore created using one of the three concrete subclasses:
  * ConstantExp, IdentifierExp, or CompoundExp.
+ * Nodes are made in an Arena and are never deleted one by one.
  */
 
 class Expression {
@@ -37,16 +48,19 @@ class Expression {
 public:
 
    Expression() {}
-   virtual ~Expression() {}
    virtual int eval(EvaluationContext & context) = 0;
    virtual std::string toString() = 0;
    virtual std::string toTree(int level) = 0;
    virtual ExpressionType type() = 0;
 
+   /* bind variables to the slots of a context */
+   virtual void resolve(EvaluationContext &) {}
+
    /* Getter methods for convenience */
    virtual int getConstantValue() {return 0;}
    virtual std::string getIdentifierName() {return "";}
-   virtual std::string getOperator() {return "";}
+   virtual int getSlot() {return -1;}
+   virtual Operator getOperator() {return PLUS;}
    virtual Expression *getLHS() {return nullptr;}
    virtual Expression *getRHS() {return nullptr;}
 
@@ -87,18 +101,23 @@ class IdentifierExp: public Expression {
 
 public:
 
-   IdentifierExp(std::string name);
+   // name must live as long as the node, e.g. in the same arena
+   IdentifierExp(const char *name);
 
    virtual int eval(EvaluationContext & context) override;
    virtual std::string toString() override;
    virtual std::string toTree(int level) override;
    virtual ExpressionType type() override;
 
+   virtual void resolve(EvaluationContext &context) override;
+
    virtual std::string getIdentifierName() override;
+   virtual int getSlot() override;
 
 private:
 
-   std::string name;
+   const char *name;
+   int slot;
 
 };
 
@@ -112,21 +131,30 @@ class CompoundExp: public Expression {
 
 public:
 
-   CompoundExp(std::string op, Expression *lhs, Expression *rhs);
-   virtual ~CompoundExp();
+   CompoundExp(Operator op, Expression *lhs, Expression *rhs);
+
+   // the symbol of an operator
+   static std::string name(Operator op);
+   // apply an operator to two values
+   static int apply(Operator op, int left, int right);
+   // base ** exponent wrapping around, 0 for a negative exponent,
+   // in time of the bits of the exponent
+   static int power(int base, int exponent);
 
    virtual int eval(EvaluationContext & context) override;
    virtual std::string toString() override;
    virtual std::string toTree(int level) override;
    virtual ExpressionType type() override;
 
-   virtual std::string getOperator() override;
+   virtual void resolve(EvaluationContext &context) override;
+
+   virtual Operator getOperator() override;
    virtual Expression *getLHS() override;
    virtual Expression *getRHS() override;
 
 private:
 
-   std::string op;
+   Operator op;
    Expression *lhs, *rhs;
 
 };
@@ -135,20 +163,42 @@ private:
  * Class: EvaluationContext
  * ------------------------
  * This class encapsulates the information that the evaluator needs to
- * know in order to evaluate an expression.
+ * know in order to evaluate an expression.  Every variable is given
+ * a slot when it is first mentioned; values are kept in a dense array
+ * indexed by slot, with a bitmap telling which of them are defined.
  */
 
 class EvaluationContext {
 
 public:
 
-   void setValue(std::string var, int value);
-   int getValue(std::string var);
-   bool isDefined(std::string var);
+   /* access by name, used by direct commands */
+   void setValue(const std::string &var, int value);
+   int getValue(const std::string &var);
+   bool isDefined(const std::string &var);
+
+   // slot of a variable, a new one is allocated if needed
+   int slot(const std::string &var);
+   // name of the variable in a slot
+   const std::string &name(int slot) const {return names[slot];}
+   // number of slots allocated
+   int size() const {return names.size();}
+   // memory taken by the table, roughly, in bytes
+   std::size_t bytes() const;
+
+   /* access by slot, used during execution */
+   void setValue(int slot, int value) {values[slot] = value; defined[slot] = true;}
+   int getValue(int slot) const {return values[slot];}
+   bool isDefined(int slot) const {return defined[slot];}
+   // values of all the slots, for code working on them directly
+   int *data() {return values.data();}
 
 private:
 
    std::map<std::string, int> symbolTable;
+   std::vector<std::string> names;
+   std::vector<int> values;
+   std::vector<bool> defined;
 
 };
 
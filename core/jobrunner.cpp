@@ -0,0 +1,150 @@
+#include "jobrunner.h"
+#include "dataflow.h"
+#include "loader.h"
+#include "parser.h"
+#include "program.h"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+/* a program shared by all the jobs with its source */
+struct Shared {
+    Program program;
+    std::unique_ptr<Bytecode> code;
+    std::string error;
+};
+
+/* tasks of one thread, taken from the back by it
+ * and from the front by the others */
+struct Queue {
+    std::mutex lock;
+    std::deque<std::size_t> tasks;
+};
+
+// run task(0) ... task(count - 1) on a pool of threads
+void parallel(std::size_t count, unsigned threads, const std::function<void(std::size_t)> &task) {
+    threads = std::max<std::size_t>(1, std::min<std::size_t>(threads, count));
+    std::vector<Queue> queues(threads);
+    for (std::size_t i = 0; i < count; i++)
+        queues[i * threads / count].tasks.push_back(i);
+
+    // no task is added once started, so all queues empty means done
+    auto work = [&](unsigned self) {
+        for (;;) {
+            std::size_t i = count;
+            for (unsigned k = 0; k < threads && i == count; k++) {
+                Queue &queue = queues[(self + k) % threads];
+                std::lock_guard<std::mutex> guard(queue.lock);
+                if (queue.tasks.empty())
+                    continue;
+                if (k == 0) {
+                    i = queue.tasks.back();
+                    queue.tasks.pop_back();
+                } else {
+                    i = queue.tasks.front();
+                    queue.tasks.pop_front();
+                }
+            }
+            if (i == count)
+                return;
+            task(i);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; i++)
+        pool.emplace_back(work, i);
+    work(0);
+    for (auto &thread : pool)
+        thread.join();
+}
+
+// parse and compile a source, keeping the error if it fails
+void prepare(Shared &shared, const std::string &source) {
+    try {
+        // already on a thread of the pool, so the loader needs no more
+        Loader loader(source.data(), source.data() + source.size(), &shared.program, Loader::Progress(), 1);
+    } catch (ParseException &e) {
+        shared.error = e.what();
+        return;
+    }
+    shared.code.reset(new Bytecode(shared.program.statements()));
+    if (shared.code->link() >= 0)
+        shared.error = RuntimeException("no matching line number").what();
+    else
+        Dataflow(*shared.code, shared.program.variables()).apply(*shared.code);
+}
+
+// run a job on a machine of its own, over a copy of the variables
+void execute(Shared &shared, const std::vector<int> &inputs, const Limits &limits,
+             std::string &output, std::string &error) {
+    if (!shared.error.empty()) {
+        error = shared.error;
+        return;
+    }
+    if (shared.code->starts.empty())
+        return;
+
+    EvaluationContext context = shared.program.variables();
+    Machine machine(*shared.code, context);
+    std::size_t next = 0;
+    std::string out, var;
+    try {
+        machine.setLimits(limits);
+        for (;;) {
+            ProgramState state = machine.run(out, var);
+            if (!out.empty()) {
+                output += out;
+                output += '\n';
+                out.clear();
+            }
+            if (state != INPUTTING)
+                return;
+            if (next >= inputs.size())
+                throw RuntimeException("no input for `" + var + "`");
+            context.setValue(var, inputs[next++]);
+            machine.jump(machine.line() + 1);
+        }
+    } catch (RuntimeException &e) {
+        if (!out.empty())
+            output += out + '\n';
+        error = e.what();
+    }
+}
+
+}
+
+JobRunner::JobRunner(const std::vector<Job> &jobs, unsigned threads, const Limits &limits):
+    outputs(jobs.size()),
+    errors(jobs.size()),
+    programs(0) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // jobs with the same source get the same program
+    std::unordered_map<std::string, std::size_t> index;
+    std::vector<const std::string *> sources;
+    std::vector<std::size_t> of(jobs.size());
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        auto it = index.emplace(jobs[i].source, sources.size());
+        if (it.second)
+            sources.push_back(&jobs[i].source);
+        of[i] = it.first->second;
+    }
+    programs = sources.size();
+
+    std::vector<std::unique_ptr<Shared>> shared(programs);
+    parallel(programs, threads, [&](std::size_t i) {
+        shared[i].reset(new Shared);
+        prepare(*shared[i], *sources[i]);
+    });
+    parallel(jobs.size(), threads, [&](std::size_t i) {
+        execute(*shared[of[i]], jobs[i].inputs, limits, outputs[i], errors[i]);
+    });
+}
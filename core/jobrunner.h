@@ -0,0 +1,51 @@
+#ifndef JOBRUNNER_H
+#define JOBRUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "machine.h"
+
+/*
+ * Type: Job
+ * -----------------
+ * This type is used to describe one run of a program: its source
+ * text, as in a .basic file, and the values given to its INPUTs.
+ */
+
+struct Job {
+    std::string source;
+    std::vector<int> inputs;
+};
+
+/*
+ * Class: JobRunner
+ * -----------------
+ * This class runs many independent jobs on a pool of threads.
+ * Jobs with the same source share one program, parsed and compiled
+ * once and only read afterwards, while each job runs on a machine
+ * and variables of its own.  Every thread has a queue of jobs and
+ * takes from the queues of others when its own runs out, so that
+ * a few long jobs do not leave the other threads idle.  Each job
+ * runs under the same limits, and one passing them stops with a
+ * runtime error like any other.
+ */
+
+class JobRunner {
+
+public:
+
+    // runs on as many threads as the machine has cores if none given
+    JobRunner(const std::vector<Job> &jobs, unsigned threads = 0, const Limits &limits = Limits());
+
+    /* what each job has printed, one value per line, and the
+     * parse or runtime error it stopped with, if any */
+    std::vector<std::string> outputs;
+    std::vector<std::string> errors;
+
+    // number of different sources, each parsed once
+    std::size_t programs;
+
+};
+
+#endif // JOBRUNNER_H
@@ -0,0 +1,134 @@
+#include "loader.h"
+#include "parser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <thread>
+
+/* least number of bytes parsed by one chunk */
+static const std::size_t CHUNK_SIZE = 64 * 1024;
+
+/* chunks for every thread, so that they end at about the same time */
+static const std::size_t CHUNKS_PER_THREAD = 8;
+
+namespace {
+
+struct Chunk {
+    const char *begin, *end;
+    Arena *arena;
+    std::vector<std::pair<int, Statement *>> lines;
+    std::exception_ptr error;
+};
+
+// parse the lines of a chunk until the end or the first error
+void parse(Chunk &chunk) {
+    Tokenizer tokenizer(chunk.begin, chunk.begin);
+    const char *p = chunk.begin;
+    while (p < chunk.end) {
+        const char *eol = static_cast<const char *>(std::memchr(p, '\n', chunk.end - p));
+        if (eol == nullptr)
+            eol = chunk.end;
+        const char *begin = p;
+        p = eol + 1;
+        if (begin == eol)
+            continue;
+
+        tokenizer.scan(begin, eol);
+
+        // only accepts lines with a line number
+        if (tokenizer.tokens.empty())
+            throw ParseException("illegal line number");
+        const Token &number = tokenizer.tokens[0];
+        if (number.kind != T_NUMBER || number.overflow || number.value <= 0)
+            throw ParseException("illegal line number");
+
+        // a bare line number gives a null statement, which deletes the line
+        StmtParser parser(tokenizer, 1, *chunk.arena);
+        chunk.lines.emplace_back(number.value, parser.statement);
+    }
+}
+
+}
+
+Loader::Loader(const char *begin, const char *end, Program *program,
+               const Progress &progress, unsigned threads) {
+    std::size_t total = end - begin;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // cut the buffer into chunks of whole lines
+    std::size_t size = std::max(CHUNK_SIZE, total / (threads * CHUNKS_PER_THREAD) + 1);
+    std::vector<Chunk> chunks;
+    for (const char *p = begin; p < end;) {
+        const char *q = p + std::min(size, std::size_t(end - p));
+        const char *eol = static_cast<const char *>(std::memchr(q, '\n', end - q));
+        q = eol == nullptr ? end : eol + 1;
+        chunks.push_back(Chunk{p, q, nullptr, {}, nullptr});
+        p = q;
+    }
+
+    // every thread takes the next chunk, until one fails
+    std::atomic<std::size_t> next(0), done(0), failed(chunks.size());
+    auto work = [&]() {
+        for (;;) {
+            std::size_t i = next++;
+            if (i >= chunks.size() || i > failed)
+                return;
+            Chunk &chunk = chunks[i];
+            chunk.arena = new Arena;
+            try {
+                parse(chunk);
+            } catch (...) {
+                chunk.error = std::current_exception();
+                for (std::size_t j = failed; i < j && !failed.compare_exchange_weak(j, i);)
+                    ;
+            }
+            std::size_t bytes = done += chunk.end - chunk.begin;
+            if (progress)
+                progress(bytes, total);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < std::min<std::size_t>(threads, chunks.size()); ++i)
+        pool.emplace_back(work);
+    work();
+    for (auto &thread : pool)
+        thread.join();
+
+    // lines before the first failing one, in the order of the source
+    std::vector<std::pair<int, Statement *>> lines;
+    std::vector<Arena *> arenas;
+    std::exception_ptr error;
+    for (auto &chunk : chunks) {
+        if (chunk.arena == nullptr)
+            continue;
+        if (error != nullptr) {
+            delete chunk.arena;
+            continue;
+        }
+        arenas.push_back(chunk.arena);
+        lines.insert(lines.end(), chunk.lines.begin(), chunk.lines.end());
+        error = chunk.error;
+    }
+
+    // sort by line number, the last of the same number wins,
+    // even if it is a bare number which deletes the line
+    auto less = [](const std::pair<int, Statement *> &a, const std::pair<int, Statement *> &b) {
+        return a.first < b.first;
+    };
+    if (!std::is_sorted(lines.begin(), lines.end(), less))
+        std::stable_sort(lines.begin(), lines.end(), less);
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        if (n > 0 && lines[n - 1].first == lines[i].first)
+            --n;
+        lines[n++] = lines[i];
+    }
+    lines.resize(n);
+
+    program->insert(lines, arenas);
+    if (error != nullptr)
+        std::rethrow_exception(error);
+}
@@ -0,0 +1,33 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <cstddef>
+#include <functional>
+
+#include "program.h"
+
+/*
+ * Class: Loader
+ * -----------------
+ * This class reads a program from a buffer, usually a mapped file.
+ * The buffer is cut into chunks of whole lines, which are parsed
+ * on several threads and then put into the program at once.
+ * Every non-empty line must start with a line number, and when
+ * a line is given twice, the later one wins.  Loading stops at
+ * the first line that fails to parse: the lines before it are
+ * kept and the error is thrown again.
+ */
+
+class Loader {
+
+public:
+
+    // gets the bytes parsed so far and in total, maybe on any thread
+    typedef std::function<void(std::size_t, std::size_t)> Progress;
+
+    Loader(const char *begin, const char *end, Program *program,
+           const Progress &progress = Progress(), unsigned threads = 0);
+
+};
+
+#endif // LOADER_H
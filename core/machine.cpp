@@ -0,0 +1,304 @@
+#include "machine.h"
+#include "program.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+
+typedef std::chrono::steady_clock Clock;
+
+/* backward jumps to an instruction before a trace is recorded from it */
+static const unsigned HOT = 100;
+
+/* instructions between two looks at the clock, under a time limit */
+static const long long PERIOD = 1 << 16;
+
+Machine::Machine(const Bytecode &code, EvaluationContext &context):
+    code(code),
+    context(context),
+    ip(0),
+    stack(code.depth + 1),
+    heat(code.code.size(), 0),
+    traces(code.code.size(), nullptr),
+    limits(),
+    fuel(LLONG_MAX),
+    given(LLONG_MAX),
+    steps(LLONG_MAX),
+    timeLeft(0),
+    profiling(false),
+    recorder(nullptr) {
+
+}
+
+Machine::~Machine() {
+    for (Trace *trace : traces)
+        delete trace;
+}
+
+int Machine::loop(int head, std::string &out, long long &slice) {
+    Trace *&trace = traces[head];
+    if (trace == nullptr) {
+        trace = new Trace(code, context, head);
+        if (!trace->recorded) {
+            // try again later, the loop may go another way then
+            delete trace;
+            trace = nullptr;
+            heat[head] = 0;
+            return head;
+        }
+    }
+    return trace->run(context, out, slice, fuel);
+}
+
+void Machine::dropTraces() {
+    for (Trace *&trace : traces) {
+        delete trace;
+        trace = nullptr;
+    }
+    std::fill(heat.begin(), heat.end(), 0);
+}
+
+void Machine::setLimits(const Limits &limits) {
+    if (limits.bytes > 0 && (long long)context.bytes() > limits.bytes)
+        throw LimitException("variables over the memory limit of " + std::to_string(limits.bytes) + " bytes");
+    this->limits = limits;
+    steps = limits.steps > 0 ? limits.steps : LLONG_MAX;
+    timeLeft = std::chrono::milliseconds(limits.millis);
+    given = fuel = limits.millis > 0 ? std::min(steps, PERIOD) : steps;
+}
+
+void Machine::refuel() {
+    steps -= given - fuel;
+    if (steps < 0)
+        throw LimitException("instruction limit of " + std::to_string(limits.steps) + " reached");
+    if (limits.millis > 0 && Clock::now() >= deadline)
+        throw LimitException("time limit of " + std::to_string(limits.millis) + " ms reached");
+    given = fuel = limits.millis > 0 ? std::min(steps, PERIOD) : steps;
+}
+
+void Machine::jump(int index) {
+    if (index < 0 || index >= (int)code.starts.size())
+        ip = code.code.size() - 1; // the final OP_END
+    else
+        ip = code.starts[index];
+}
+
+int Machine::line() const {
+    return code.lineOf(ip);
+}
+
+void Machine::findEntries() {
+    if (!entries.empty())
+        return;
+    entries.assign(code.code.size(), -1);
+    for (int line = 0; line < (int)code.starts.size(); line++)
+        entries[code.starts[line]] = line; // an empty line shares its start with the next
+    profile.assign(code.starts.size(), LineProfile());
+}
+
+void Machine::setProfiling(bool on) {
+    profiling = on;
+    if (on)
+        findEntries();
+}
+
+void Machine::setRecorder(Recorder *recorder) {
+    this->recorder = recorder;
+    if (recorder != nullptr)
+        findEntries();
+}
+
+void Machine::clearProfile() {
+    std::fill(profile.begin(), profile.end(), LineProfile());
+}
+
+ProgramState Machine::run(std::string &out, std::string &var, long long slice) {
+    if (slice <= 0)
+        slice = LLONG_MAX;
+    if (limits.millis <= 0)
+        return dispatch(out, var, slice);
+
+    // the clock only runs while the machine does
+    deadline = Clock::now() + timeLeft;
+    ProgramState state;
+    try {
+        state = dispatch(out, var, slice);
+    } catch (RuntimeException &) {
+        timeLeft = deadline - Clock::now();
+        throw;
+    }
+    timeLeft = deadline - Clock::now();
+    return state;
+}
+
+ProgramState Machine::dispatch(std::string &out, std::string &var, long long slice) {
+    if (recorder != nullptr)
+        return profiling ? exec<true, true>(out, var, slice) : exec<false, true>(out, var, slice);
+    return profiling ? exec<true, false>(out, var, slice) : exec<false, false>(out, var, slice);
+}
+
+template <bool PROFILE, bool RECORD>
+ProgramState Machine::exec(std::string &out, std::string &var, long long slice) {
+    const Instruction *base = code.code.data();
+    const Instruction *i = base + ip;
+    int *sp = stack.data();
+    int lhs;
+
+    // the line being timed or recorded, and when it was entered
+    int current = PROFILE || RECORD ? code.lineOf(ip) : 0;
+    Clock::time_point since;
+    if (PROFILE)
+        since = Clock::now();
+
+    // charge the time so far to the current line
+#define CHARGE { \
+    if (PROFILE) { \
+        Clock::time_point now = Clock::now(); \
+        profile[current].nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(now - since).count(); \
+        since = now; \
+    } \
+}
+
+    // keep ip on the failing instruction, so that line() reports it
+#define FAIL(err) { \
+    ip = i - base; \
+    CHARGE \
+    throw RuntimeException(err); \
+}
+
+    // jump to arg, pausing on a backward jump once the slice is used up;
+    // a loop jumped back to often enough goes on in its trace.  Only the
+    // code from the target up to here may have run since the last backward
+    // jump, and that is what is taken from the fuel
+#define JUMP { \
+    int target = i->arg; \
+    if (RECORD) \
+        recorder->record(EV_JUMP, code.numbers[current], code.numbers[entries[target]]); \
+    if (target <= i - base) { \
+        if ((fuel -= i - base - target + 1) < 0) { \
+            ip = target; \
+            refuel(); \
+        } \
+        if (--slice == 0) { \
+            ip = target; \
+            CHARGE \
+            return RUNNING; \
+        } \
+        if (!PROFILE && !RECORD && ++heat[target] >= HOT) { \
+            target = loop(target, out, slice); \
+            if (fuel < 0) { \
+                ip = target; \
+                refuel(); \
+            } \
+            if (slice <= 0) { \
+                ip = target; \
+                return RUNNING; \
+            } \
+        } \
+    } \
+    i = base + target; \
+    continue; \
+}
+
+    // jump if the condition holds, counting both ways for IF lines
+#define BRANCH(cond) { \
+    bool taken = cond; \
+    if (PROFILE) \
+        (taken ? profile[current].taken : profile[current].notTaken)++; \
+    if (taken) \
+        JUMP \
+    break; \
+}
+
+    for (;;) {
+        if ((PROFILE || RECORD) && entries[i - base] >= 0) {
+            CHARGE
+            current = entries[i - base];
+            if (PROFILE)
+                profile[current].hits++;
+            if (RECORD)
+                recorder->record(EV_LINE, code.numbers[current]);
+        }
+
+        switch (i->op) {
+        case OP_CONST:
+            *sp++ = i->arg;
+            break;
+        case OP_LOAD:
+            if (!context.isDefined(i->arg))
+                FAIL("`" + context.name(i->arg) + "` is not declared");
+            *sp++ = context.getValue(i->arg);
+            break;
+        case OP_LOAD_UNCHECKED:
+            *sp++ = context.getValue(i->arg);
+            break;
+        case OP_ADD:
+            lhs = *--sp;
+            sp[-1] = lhs + sp[-1];
+            break;
+        case OP_SUB:
+            lhs = *--sp;
+            sp[-1] = lhs - sp[-1];
+            break;
+        case OP_MUL:
+            lhs = *--sp;
+            sp[-1] = lhs * sp[-1];
+            break;
+        case OP_DIV:
+            lhs = *--sp;
+            if (sp[-1] == 0)
+                FAIL("divide by zero");
+            sp[-1] = lhs / sp[-1];
+            break;
+        case OP_POW:
+            // in time of the bits of the exponent, so that it costs
+            // about as much as the one instruction it is counted as
+            lhs = *--sp;
+            sp[-1] = CompoundExp::power(lhs, sp[-1]);
+            break;
+        case OP_STORE:
+            context.setValue(i->arg, *--sp);
+            break;
+        case OP_PRINT:
+            lhs = *--sp;
+            if (RECORD)
+                recorder->record(EV_PRINT, code.numbers[current], lhs);
+            if (!out.empty())
+                out += '\n';
+            out += std::to_string(lhs);
+            break;
+        case OP_INPUT:
+            if (RECORD)
+                recorder->record(EV_INPUT, code.numbers[current], i->arg);
+            ip = i - base;
+            var = context.name(i->arg);
+            CHARGE
+            return INPUTTING;
+        case OP_GOTO:
+            JUMP
+        case OP_IFLT:
+            sp -= 2;
+            BRANCH(sp[0] < sp[1])
+        case OP_IFGT:
+            sp -= 2;
+            BRANCH(sp[0] > sp[1])
+        case OP_IFEQ:
+            sp -= 2;
+            BRANCH(sp[0] == sp[1])
+        case OP_END:
+            ip = 0;
+            CHARGE
+            return BEGIN;
+        case OP_BREAK:
+            ip = i - base;
+            CHARGE
+            return PAUSED;
+        }
+        i++;
+    }
+
+#undef BRANCH
+#undef JUMP
+#undef FAIL
+#undef CHARGE
+}
@@ -0,0 +1,147 @@
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "exp.h"
+#include "bytecode.h"
+#include "recorder.h"
+#include "trace.h"
+
+/*
+ * Type: ProgramState
+ * -----------------
+ * This enumerated type is used to describe different
+ * states of this program.
+ */
+
+enum ProgramState { BEGIN, RUNNING, INPUTTING, PAUSED };
+
+/*
+ * Type: LineProfile
+ * -----------------
+ * This type is used to record how often a line has been
+ * executed and how long it has taken.
+ */
+
+struct LineProfile {
+    long long hits;      // times the line has been entered
+    long long nanos;     // time spent in the line, in nanoseconds
+    long long taken;     // times an IF line has jumped
+    long long notTaken;  // times an IF line has fallen through
+};
+
+/*
+ * Type: Limits
+ * -----------------
+ * This type is used to bound a run of a program: how many bytecode
+ * instructions it may execute, how long it may run, not counting
+ * waits for input, and how much memory its variables may take.
+ * Zero means no limit.
+ */
+
+struct Limits {
+    long long steps;     // instructions executed
+    long long millis;    // time spent running, in milliseconds
+    long long bytes;     // memory of the variable table, in bytes
+};
+
+/*
+ * Class: Machine
+ * -----------------
+ * This class is a stack machine which executes compiled
+ * bytecode in a dispatch loop.  The bytecode is only read,
+ * all states live in the machine and the evaluation context.
+ * Loops which jump back often enough are traced, and their
+ * traces run instead of the bytecode while they hold.
+ */
+
+class Machine {
+
+public:
+
+    Machine(const Bytecode &code, EvaluationContext &context);
+    ~Machine();
+
+    // execute until END or INPUT, printed values are appended to out,
+    // the name of the variable to be input is stored in var;
+    // with a positive slice, also return RUNNING after that many
+    // backward jumps, so that a long loop can be run piece by piece;
+    // PAUSED at an OP_BREAK, which is left for the caller to pass
+    ProgramState run(std::string &out, std::string &var, long long slice = 0);
+
+    // count a new run from now on, under the limits; throws
+    // LimitException if the variables take too much memory already
+    void setLimits(const Limits &limits);
+
+    // move to the beginning of a line, given by its index
+    void jump(int index);
+    // index of the line under execution, and of the next instruction
+    int line() const;
+    int position() const {return ip;}
+
+    // forget the traces, which do not see the code patched since
+    void dropTraces();
+
+    // record a profile of every line or not
+    void setProfiling(bool on);
+    void clearProfile();
+    // counters of every line, by index, while profiling has been on
+    const std::vector<LineProfile> &getProfile() const {return profile;}
+
+    // record the lines entered, jumps, values printed and INPUT waits
+    // of the runs from now on, or nothing with null; loops are not
+    // traced while recording, so that every line is seen
+    void setRecorder(Recorder *recorder);
+
+private:
+
+    // the dispatch loop, with or without profiling and recording
+    template <bool PROFILE, bool RECORD>
+    ProgramState exec(std::string &out, std::string &var, long long slice);
+    // the dispatch loop for what is switched on
+    ProgramState dispatch(std::string &out, std::string &var, long long slice);
+    // find the line starting at each instruction
+    void findEntries();
+
+    // run the trace of a hot loop, recording it first if needed,
+    // returns the instruction index where the loop is left
+    int loop(int head, std::string &out, long long &slice);
+
+    // take the instructions run since the last time from the budget
+    // and look at the clock, throws LimitException once one is passed
+    void refuel();
+
+    const Bytecode &code;
+    EvaluationContext &context;
+
+    /* instruction pointer: index of the next instruction */
+    int ip;
+    std::vector<int> stack;
+
+    /* backward jumps to each instruction, and traces of hot loops */
+    std::vector<unsigned> heat;
+    std::vector<Trace *> traces;
+
+    /* limits: instructions to run before the next refuel(), out of
+     * those given then, and out of all those left; time left to run,
+     * and when it is up during a run */
+    Limits limits;
+    long long fuel, given, steps;
+    std::chrono::steady_clock::duration timeLeft;
+    std::chrono::steady_clock::time_point deadline;
+
+    /* profile: the line index starting at each instruction, or -1,
+     * also used to record lines */
+    bool profiling;
+    std::vector<int> entries;
+    std::vector<LineProfile> profile;
+
+    /* events of the runs, not owned, null when not recording */
+    Recorder *recorder;
+
+};
+
+#endif // MACHINE_H
@@ -0,0 +1,79 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &path):
+    opened(false),
+    begin(""),
+    length(0),
+    file(INVALID_HANDLE_VALUE),
+    mapping(nullptr) {
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+        return;
+    opened = true;
+    if (size.QuadPart == 0) // an empty file can not be mapped
+        return;
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr) {
+        opened = false;
+        return;
+    }
+    begin = static_cast<const char *>(view);
+    length = size.QuadPart;
+}
+
+MappedFile::~MappedFile() {
+    if (length > 0)
+        UnmapViewOfFile(begin);
+    if (mapping != nullptr)
+        CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path):
+    opened(false),
+    begin(""),
+    length(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        opened = true;
+        if (st.st_size > 0) { // an empty file can not be mapped
+            void *view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view == MAP_FAILED) {
+                opened = false;
+            } else {
+                begin = static_cast<const char *>(view);
+                length = st.st_size;
+            }
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (length > 0)
+        munmap(const_cast<char *>(begin), length);
+}
+
+#endif
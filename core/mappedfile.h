@@ -0,0 +1,40 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/*
+ * Class: MappedFile
+ * -----------------
+ * This class maps a whole file into memory, read only.
+ * The contents stay valid as long as the object lives.
+ */
+
+class MappedFile {
+
+public:
+
+    MappedFile(const std::string &path);
+    ~MappedFile();
+
+    bool isOpen() const {return opened;}
+    const char *data() const {return begin;}
+    std::size_t size() const {return length;}
+
+private:
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool opened;
+    const char *begin;
+    std::size_t length;
+
+#ifdef _WIN32
+    void *file, *mapping;
+#endif
+
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,62 @@
+#include "optimizer.h"
+
+#include <climits>
+
+bool Optimizer::canFail(Expression *exp) {
+    switch (exp->type()) {
+    case CONSTANT:
+        return false;
+    case IDENTIFIER:
+        return true;
+    case COMPOUND:
+        // dividing by 0, or INT_MIN by -1, fails
+        if (exp->getOperator() == DIVIDE &&
+                (exp->getRHS()->type() != CONSTANT || exp->getRHS()->getConstantValue() == 0 ||
+                 exp->getRHS()->getConstantValue() == -1))
+            return true;
+        return canFail(exp->getLHS()) || canFail(exp->getRHS());
+    }
+    return true;
+}
+
+Optimizer::Optimizer(Expression *exp, Arena &arena):
+    expression(nullptr),
+    arena(arena) {
+    expression = optimize(exp);
+}
+
+Expression *Optimizer::optimize(Expression *exp) {
+    if (exp->type() == CONSTANT)
+        return exp;
+    if (exp->type() == IDENTIFIER)
+        return exp;
+
+    Operator op = exp->getOperator();
+    Expression *lhs = optimize(exp->getLHS());
+    Expression *rhs = optimize(exp->getRHS());
+    bool lconst = lhs->type() == CONSTANT, rconst = rhs->type() == CONSTANT;
+    int left = lhs->getConstantValue(), right = rhs->getConstantValue();
+
+    // fold constants, except a division by zero, or of INT_MIN by -1,
+    // which overflows: both must fail at runtime, not while compiling
+    if (lconst && rconst && !(op == DIVIDE && (right == 0 || (left == INT_MIN && right == -1))))
+        return arena.make<ConstantExp>(CompoundExp::apply(op, left, right));
+
+    // x + 0, x - 0, x * 1, x / 1, x ** 1
+    if (rconst && ((right == 0 && (op == PLUS || op == MINUS)) ||
+                   (right == 1 && (op == TIMES || op == DIVIDE || op == POWER))))
+        return lhs;
+
+    // 0 + x, 1 * x
+    if (lconst && ((left == 0 && op == PLUS) || (left == 1 && op == TIMES)))
+        return rhs;
+
+    // x ** 0, as long as x would not have failed
+    if (rconst && right == 0 && op == POWER && !canFail(lhs))
+        return arena.make<ConstantExp>(1);
+
+    // keep the node as it is if nothing below has changed
+    if (lhs == exp->getLHS() && rhs == exp->getRHS())
+        return exp;
+    return arena.make<CompoundExp>(op, lhs, rhs);
+}
@@ -0,0 +1,42 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "exp.h"
+#include "arena.h"
+
+/*
+ * Class: Optimizer
+ * -----------------
+ * This class simplifies an expression before it is compiled.
+ * Constant subtrees are folded into a ConstantExp, and operands
+ * which do not change the result (x + 0, x - 0, x * 1, x / 1,
+ * x ** 1) are dropped.  x ** 0 becomes 1 only when x can not fail.
+ * Whatever may fail at runtime, such as a division by zero or an
+ * undeclared variable, is kept, so that it still fails the same way.
+ *
+ * The given expression is left untouched: the simplified tree is
+ * built in the given arena, sharing the subtrees that stay the same.
+ */
+
+class Optimizer {
+
+public:
+
+    // decide whether evaluating an expression may throw
+    static bool canFail(Expression *exp);
+
+public:
+
+    Optimizer(Expression *exp, Arena &arena);
+
+    Expression *expression;
+
+private:
+
+    Expression *optimize(Expression *exp);
+
+    Arena &arena;
+
+};
+
+#endif // OPTIMIZER_H
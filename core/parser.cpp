@@ -0,0 +1,220 @@
+#include "parser.h"
+
+#include <iostream>
+
+bool ExpParser::isNumber(TokenKind k) {
+    return k == T_NUMBER;
+}
+
+bool ExpParser::isName(TokenKind k) {
+    return k >= T_NAME && k <= T_END;
+}
+
+bool ExpParser::isOperator(TokenKind k) {
+    return k >= T_PLUS && k <= T_RPAREN;
+}
+
+bool ExpParser::isLever1(TokenKind k) {
+    return k == T_PLUS || k == T_MINUS;
+}
+
+bool ExpParser::isLever2(TokenKind k) {
+    return k == T_TIMES || k == T_DIVIDE;
+}
+
+bool ExpParser::isLever3(TokenKind k) {
+    return k == T_POWER;
+}
+
+Operator ExpParser::toOperator(TokenKind k) {
+    switch (k) {
+    case T_PLUS: return PLUS;
+    case T_MINUS: return MINUS;
+    case T_TIMES: return TIMES;
+    case T_DIVIDE: return DIVIDE;
+    case T_POWER: return POWER;
+    default: throw ParseException("illegal operator in expression");
+    }
+}
+
+bool ExpParser::isSigned(const std::vector<Token> &tokens, int i, int begin, int end) {
+    // legal cases: -1+2 ; 1-(-2)
+    return isLever1(tokens[i].kind) &&
+            (i == begin || tokens[i - 1].kind == T_LPAREN) &&
+            (i < end - 1 && (isNumber(tokens[i + 1].kind) || isName(tokens[i + 1].kind)));
+}
+
+ExpParser::ExpParser(const Tokenizer &tokenizer, int begin, int end, Arena &arena):
+    expression(nullptr),
+    tokenizer(tokenizer),
+    tokens(tokenizer.tokens),
+    begin(begin),
+    end(end),
+    pos(begin),
+    arena(arena) {
+    // illegal case: ()
+    for (int i = begin; i < end - 1; i++)
+        if (tokens[i].kind == T_LPAREN && tokens[i + 1].kind == T_RPAREN)
+            throw ParseException("illegal expression");
+
+    expression = binary(operand(), 1);
+
+    // to avoid cases: 1+2) ; (1)(2) ; 1+(2)3
+    if (pos < end) {
+        if (tokens[pos].kind == T_RPAREN)
+            throw ParseException("expected \"(\" to match \")\"");
+        throw ParseException("illegal expression");
+    }
+}
+
+Expression *ExpParser::operand() {
+    if (pos == end)
+        throw ParseException("incomplete expression");
+    const Token &t = tokens[pos];
+
+    if (isNumber(t.kind)) {
+        pos++;
+        return arena.make<ConstantExp>(t.value);
+    }
+    if (isName(t.kind)) {
+        pos++;
+        return arena.make<IdentifierExp>(arena.copy(tokenizer.source + t.offset, t.length));
+    }
+    if (t.kind == T_LPAREN) {
+        pos++;
+        Expression *exp = binary(operand(), 1);
+        if (pos == end || tokens[pos].kind != T_RPAREN)
+            throw ParseException("expected \")\" to match \"(\"");
+        pos++;
+        return exp;
+    }
+    if (isSigned(tokens, pos, begin, end)) // as if a 0 stood ahead
+        return arena.make<ConstantExp>(0);
+    if (isOperator(t.kind))
+        throw ParseException("incomplete expression");
+    throw ParseException("illegal expression");
+}
+
+int ExpParser::precedence() const {
+    if (pos == end)
+        return 0;
+    switch (tokens[pos].kind) {
+    case T_PLUS: case T_MINUS: return 1;
+    case T_TIMES: case T_DIVIDE: return 2;
+    case T_POWER: return 3;
+    default: return 0;
+    }
+}
+
+Expression *ExpParser::binary(Expression *lhs, int least) {
+    for (int op; (op = precedence()) >= least;) {
+        TokenKind k = tokens[pos++].kind;
+        Expression *rhs = operand();
+        // tighter operators take rhs first, and so does a following **
+        for (int next; (next = precedence()) > op || (next == op && k == T_POWER);)
+            rhs = binary(rhs, next);
+        lhs = arena.make<CompoundExp>(toOperator(k), lhs, rhs);
+    }
+    return lhs;
+}
+
+bool StmtParser::isComparator(TokenKind k) {
+    return k == T_EQUAL || k == T_LESS || k == T_GREATER;
+}
+
+Comparator StmtParser::toComparator(TokenKind k) {
+    if (k == T_LESS) return LESS;
+    if (k == T_GREATER) return GREATER;
+    return EQUAL;
+}
+
+StmtParser::StmtParser(const Tokenizer &tokenizer, int begin, Arena &arena):
+    statement(nullptr) {
+    const std::vector<Token> &tokens = tokenizer.tokens;
+    int size = tokens.size() - begin;
+    if (size <= 0)
+        return;
+
+    // parsing to different statements
+    switch (tokens[begin].kind) {
+    case T_REM: {
+        std::string content;
+        for (int i = begin + 1; i < begin + size; i++) {
+            content.append(tokenizer.source + tokens[i].offset, tokens[i].length);
+            content += ' ';
+        }
+        statement = arena.make<RemStmt>(arena.copy(content));
+        break;
+    }
+    case T_LET: {
+        if (size < 4 || tokens[begin + 2].kind != T_EQUAL)
+            throw ParseException("incomplete statement, " + LetStmt::usage());
+        const Token &name = tokens[begin + 1];
+        if (!ExpParser::isName(name.kind))
+            throw ParseException("illegal variable name");
+        ExpParser parser(tokenizer, begin + 3, begin + size, arena);
+        statement = arena.make<LetStmt>(arena.copy(tokenizer.source + name.offset, name.length),
+                                        parser.expression);
+        break;
+    }
+    case T_PRINT: {
+        if (size < 2)
+            throw ParseException("incomplete statement, " + PrintStmt::usage());
+        ExpParser parser(tokenizer, begin + 1, begin + size, arena);
+        statement = arena.make<PrintStmt>(parser.expression);
+        break;
+    }
+    case T_INPUT: {
+        if (size < 2)
+            throw ParseException("incomplete statement, " + InputStmt::usage());
+        const Token &name = tokens[begin + 1];
+        if (!ExpParser::isName(name.kind))
+            throw ParseException("illegal variable name");
+        statement = arena.make<InputStmt>(arena.copy(tokenizer.source + name.offset, name.length));
+        break;
+    }
+    case T_GOTO: {
+        if (size < 2)
+            throw ParseException("incomplete statement, " + GotoStmt::usage());
+        const Token &number = tokens[begin + 1];
+        if (number.kind != T_NUMBER || number.overflow || number.value <= 0)
+            throw ParseException("illegal line number");
+        statement = arena.make<GotoStmt>(number.value);
+        break;
+    }
+    case T_IF: {
+        if (size < 6)
+            throw ParseException("incomplete statement, " + IfStmt::usage());
+        int op_i = 0, then_i = 0;
+        for (int i = begin + 1; i < begin + size; i++) {
+            if (op_i == 0 && isComparator(tokens[i].kind))
+                op_i = i;
+            if (then_i == 0 && tokens[i].kind == T_THEN)
+                then_i = i;
+        }
+        if (op_i == 0 || then_i == 0)
+            throw ParseException("incomplete statement, " + IfStmt::usage());
+        ExpParser parser(tokenizer, begin + 1, op_i, arena);
+        ExpParser parser1(tokenizer, op_i + 1, then_i, arena);
+        if (then_i + 1 >= begin + size || tokens[then_i + 1].kind != T_NUMBER || tokens[then_i + 1].overflow)
+            throw ParseException("illegal line number");
+        statement = arena.make<IfStmt>(parser.expression, toComparator(tokens[op_i].kind),
+                                       parser1.expression, tokens[then_i + 1].value);
+        break;
+    }
+    case T_END:
+        statement = arena.make<EndStmt>();
+        break;
+    default:
+        throw ParseException("illegal statement");
+    }
+}
+
+ParseException::ParseException(std::string err):
+    err(err) {
+
+}
+
+std::string ParseException::what() throw() {
+    return "parse error: " + err;
+}
@@ -0,0 +1,117 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <vector>
+
+#include "tokenizer.h"
+#include "arena.h"
+#include "exp.h"
+#include "statement.h"
+
+/*
+ * Class: ExpParser
+ * -----------------
+ * This class is a parser for expressions.  It is a precedence
+ * climbing (Pratt) parser, which reads the tokens once from left to
+ * right: operators of the same level as +, - and *, / are left
+ * associative, ** binds tighter and is right associative.  A sign at
+ * the beginning of an expression or right after "(", followed by a
+ * number or a name, is taken as if a 0 stood before it.
+ */
+
+class ExpParser {
+
+public:
+
+    /* some tools for parsing symbols */
+
+    // decide whether a token is a constant number,
+    // a variable or an operator
+    inline static bool isNumber(TokenKind k);
+    inline static bool isName(TokenKind k);
+    inline static bool isOperator(TokenKind k);
+
+    // decide an operator's precedence level
+    inline static bool isLever1(TokenKind k);
+    inline static bool isLever2(TokenKind k);
+    inline static bool isLever3(TokenKind k);
+
+    // decode an arithmetic operator
+    static Operator toOperator(TokenKind k);
+
+    // check for explicit signed numbers which need a 0 ahead
+    static bool isSigned(const std::vector<Token> &tokens, int i, int begin, int end);
+
+public:
+
+    // parse tokens [begin, end) of a tokenizer,
+    // nodes are made in the given arena
+    ExpParser(const Tokenizer &tokenizer, int begin, int end, Arena &arena);
+
+    Expression *expression;
+
+private:
+
+    // parse a number, a name or an expression in parentheses
+    Expression *operand();
+    // parse operators of the given precedence and tighter ones after lhs
+    Expression *binary(Expression *lhs, int least);
+    // precedence of the operator to be read next, 0 if there is none
+    int precedence() const;
+
+    const Tokenizer &tokenizer;
+    const std::vector<Token> &tokens;
+    int begin, end;
+    // the next token to be read
+    int pos;
+    Arena &arena;
+
+};
+
+/*
+ * Class: StmtParser
+ * -----------------
+ * This class is a parser for statements.
+ * Need to use ExpParser if it has child expressions.
+ */
+
+class StmtParser {
+
+public:
+
+    // decide whether a token is an comparation operator: <, > and =
+    inline static bool isComparator(TokenKind k);
+    // decode a comparation operator
+    static Comparator toComparator(TokenKind k);
+
+public:
+
+    // parse the tokens of a tokenizer from begin to the end,
+    // nodes are made in the given arena
+    StmtParser(const Tokenizer &tokenizer, int begin, Arena &arena);
+
+    Statement *statement;
+
+};
+
+/*
+ * Class: ParseException
+ * -----------------
+ * This is a customized exception class used to
+ * handle errors during parsing.
+ */
+
+class ParseException {
+
+private:
+
+    std::string err;
+
+public:
+
+    ParseException(std::string err);
+    std::string what() throw();
+
+};
+
+#endif // PARSER_H
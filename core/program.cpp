@@ -0,0 +1,597 @@
+#include "program.h"
+#include "dataflow.h"
+#include "parser.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+// add the counters of a machine to those by line number
+static void addProfile(std::map<int, LineProfile> &sum, const Bytecode &code, const Machine &machine) {
+    const std::vector<LineProfile> &lines = machine.getProfile();
+    for (int i = 0; i < (int)lines.size(); i++) {
+        LineProfile &line = sum[code.numbers[i]];
+        line.hits += lines[i].hits;
+        line.nanos += lines[i].nanos;
+        line.taken += lines[i].taken;
+        line.notTaken += lines[i].notTaken;
+    }
+}
+
+Program::Program():
+    pc(0),
+    code(nullptr),
+    linked(nullptr),
+    machine(nullptr),
+    profiling(false),
+    recording(false),
+    recorder(nullptr),
+    limits(),
+    starting(true),
+    paused(false) {
+
+}
+
+Program::~Program() {
+    delete machine;
+    delete code;
+    delete linked;
+    delete recorder;
+    for (auto &b : breaks)
+        delete b.second.arena;
+    for (auto &arena : owned)
+        delete arena.second;
+    for (Arena *arena : chunks)
+        delete arena;
+}
+
+std::string Program::toString() {
+    std::ostringstream ost;
+    for (auto &stmt : stmts)
+        ost << (pc == stmt.first ? "*" : " ") << stmt.first << " " << stmt.second->toString() << "\n";
+    return ost.str();
+}
+
+std::string Program::toTree() {
+    std::ostringstream ost;
+    for (auto &stmt : stmts)
+        ost << (pc == stmt.first ? "*" : " ") << stmt.first << " " << stmt.second->toTree();
+    return ost.str();
+}
+
+std::vector<int> Program::lineNumbers() {
+    std::vector<int> ret;
+    ret.reserve(stmts.size());
+    for (auto &stmt : stmts)
+        ret.push_back(stmt.first);
+    return ret;
+}
+
+Statement *Program::statement(int line) {
+    auto it = stmts.find(line);
+    return it == stmts.end() ? nullptr : it->second;
+}
+
+void Program::setCurrentLine(int line) {
+    // loads were proven from where the machine started, not from here
+    discard();
+    pc = line;
+}
+
+void Program::insert(int line, Statement *stmt, Arena *own) {
+    // the compiled form is out of date
+    discard();
+    delete linked;
+    linked = nullptr;
+
+    if (stmts.count(line) != 0) // remove the old line at first
+        stmts.erase(line);
+    auto old = owned.find(line);
+    if (old != owned.end()) {
+        delete old->second;
+        owned.erase(old);
+    }
+    if (stmt != nullptr) { // insert a new line if needed
+        stmt->resolve(context);
+        stmts.emplace(line, stmt);
+    }
+    if (own != nullptr) {
+        if (stmt != nullptr)
+            owned.emplace(line, own);
+        else
+            delete own;
+    }
+    if (!stmts.empty()) // next line to be executed
+        pc = stmts.begin()->first;
+}
+
+void Program::insert(const std::vector<std::pair<int, Statement *>> &lines, std::vector<Arena *> &arenas) {
+    discard();
+    delete linked;
+    linked = nullptr;
+
+    chunks.insert(chunks.end(), arenas.begin(), arenas.end());
+    arenas.clear();
+
+    // lines come in order, so each one goes right before the hint
+    auto hint = stmts.begin();
+    for (auto &line : lines) {
+        auto old = owned.find(line.first);
+        if (old != owned.end()) {
+            delete old->second;
+            owned.erase(old);
+        }
+        if (line.second == nullptr) {
+            hint = stmts.lower_bound(line.first);
+            if (hint != stmts.end() && hint->first == line.first)
+                hint = stmts.erase(hint);
+            continue;
+        }
+        line.second->resolve(context);
+        hint = stmts.emplace_hint(hint, line.first, line.second);
+        hint->second = line.second;
+        ++hint;
+    }
+    if (!stmts.empty())
+        pc = stmts.begin()->first;
+}
+
+void Program::adopt(Bytecode *linked) {
+    delete this->linked;
+    this->linked = linked;
+}
+
+std::vector<std::string> Program::warnings() {
+    std::vector<std::string> ret;
+    if (stmts.empty())
+        return ret;
+    // kept for the run that usually follows
+    if (linked == nullptr) {
+        linked = new Bytecode(stmts);
+        if (linked->link() >= 0) {
+            delete linked;
+            linked = nullptr;
+        }
+    }
+    if (linked == nullptr)
+        return ret;
+    const Bytecode &check = *linked;
+
+    Dataflow flow(check, context);
+    std::vector<std::pair<int, std::string>> found;
+    std::set<std::pair<int, int>> reported;
+    for (int ip : flow.unproven) {
+        int line = check.lineOf(ip), slot = check.code[ip].arg;
+        if (reported.insert(std::make_pair(line, slot)).second)
+            found.emplace_back(line, "may read `" + context.name(slot) + "` before it is set");
+    }
+    for (int line : flow.unreachable)
+        found.emplace_back(line, "is never reached");
+    std::stable_sort(found.begin(), found.end(), [](const std::pair<int, std::string> &a,
+                                                    const std::pair<int, std::string> &b) {
+        return a.first < b.first;
+    });
+    for (auto &f : found)
+        ret.push_back("warning: line " + std::to_string(check.numbers[f.first]) + " " + f.second);
+    return ret;
+}
+
+ProgramState Program::step(std::string &out, Statement *stmt) {
+    out.clear();
+    std::ostringstream ost;
+    stmt->resolve(context);
+
+    switch (stmt->type()) {
+    case LET:
+        context.setValue(stmt->getSlot(), stmt->getExpression()->eval(context));
+        return RUNNING;
+    case PRINT:
+        ost << stmt->getExpression()->eval(context);
+        out.assign(ost.str());
+        return RUNNING;
+    case INPUT:
+        context.setValue(stmt->getSlot(), 0);
+        out.assign(stmt->getIdentifierName());
+        return INPUTTING;
+    default:
+        throw RuntimeException("unknown statement");
+    }
+}
+
+void Program::prepare(bool skip) {
+    if (machine == nullptr)
+        compile();
+    if (starting) {
+        machine->setLimits(limits);
+        starting = false;
+    }
+    if (skip) {
+        // an INPUT left without a value still sets the variable, as in step()
+        const Instruction &i = original(code->starts[machine->line()]);
+        if (i.op == OP_INPUT && !context.isDefined(i.arg))
+            context.setValue(i.arg, 0);
+        machine->jump(machine->line() + 1);
+        paused = false;
+    }
+}
+
+ProgramState Program::run(std::string &out, std::string &var, bool skip, long long slice) {
+    out.clear();
+    if (stmts.empty())
+        return BEGIN;
+    prepare(skip);
+    if (recording)
+        recorder->record(EV_RESUME, code->numbers[machine->line()]);
+
+    ProgramState state;
+    try {
+        for (long long passes = 0;;) {
+            // a line stopped at goes first, the machine would stop there again
+            if (paused) {
+                if (slice > 0 && ++passes > slice) {
+                    state = RUNNING;
+                    break;
+                }
+                paused = false;
+                state = pass(out, var);
+                if (state != RUNNING)
+                    break;
+            }
+            state = machine->run(out, var, slice);
+            if (state != PAUSED)
+                break;
+
+            // at a line patched to stop at, which may have a breakpoint
+            // or only change a variable watched
+            paused = true;
+            int number = code->numbers[machine->line()];
+            auto it = breaks.find(number);
+            Statement *test = it == breaks.end() ? nullptr : it->second.test;
+            if (it != breaks.end() && (test == nullptr ||
+                IfStmt::compare(test->getOperator(), test->getExpression()->eval(context),
+                                test->getExpression1()->eval(context)))) {
+                var = "breakpoint at line " + std::to_string(number);
+                break;
+            }
+        }
+    } catch (RuntimeException &) {
+        // stay at the failing line, so that it runs again next time
+        machine->jump(machine->line());
+        pc = code->numbers[machine->line()];
+        starting = true;
+        paused = false;
+        if (recording)
+            recorder->record(EV_STOP, pc);
+        throw;
+    }
+    pc = code->numbers[machine->line()];
+    if (state == BEGIN)
+        starting = true;
+    if (recording)
+        recorder->record(EV_STOP, pc);
+    return state;
+}
+
+ProgramState Program::stepOver(std::string &out, std::string &var) {
+    out.clear();
+    if (stmts.empty())
+        return BEGIN;
+    prepare(false);
+    if (recording)
+        recorder->record(EV_RESUME, code->numbers[machine->line()]);
+
+    ProgramState state;
+    try {
+        paused = false;
+        state = pass(out, var);
+    } catch (RuntimeException &) {
+        machine->jump(machine->line());
+        pc = code->numbers[machine->line()];
+        starting = true;
+        if (recording)
+            recorder->record(EV_STOP, pc);
+        throw;
+    }
+    pc = code->numbers[machine->line()];
+    if (state == BEGIN)
+        starting = true;
+    if (recording)
+        recorder->record(EV_STOP, pc);
+    if (state == RUNNING) {
+        paused = true;
+        var = "stepped to line " + std::to_string(pc);
+        state = PAUSED;
+    }
+    return state;
+}
+
+ProgramState Program::pass(std::string &out, std::string &var) {
+    // only the final END is not at the start of a line
+    int line = machine->line();
+    if (machine->position() != code->starts[line])
+        return machine->run(out, var);
+
+    int number = code->numbers[line];
+    Statement *stmt = stmts.at(number);
+    int next = line + 1, slot = -1, was = 0;
+    if (recording)
+        recorder->record(EV_LINE, number);
+    bool defined = false;
+    if (stmt->type() == LET && watches.count(stmt->getIdentifierName()) != 0) {
+        slot = stmt->getSlot();
+        defined = context.isDefined(slot);
+        was = context.getValue(slot);
+    }
+
+    switch (stmt->type()) {
+    case LET:
+        context.setValue(stmt->getSlot(), stmt->getExpression()->eval(context));
+        break;
+    case PRINT: {
+        int value = stmt->getExpression()->eval(context);
+        if (recording)
+            recorder->record(EV_PRINT, number, value);
+        if (!out.empty())
+            out += '\n';
+        out += std::to_string(value);
+        break;
+    }
+    case INPUT:
+        if (recording)
+            recorder->record(EV_INPUT, number, stmt->getSlot());
+        var = stmt->getIdentifierName();
+        return INPUTTING;
+    case GOTO:
+        if (recording)
+            recorder->record(EV_JUMP, number, stmt->getLineNumber());
+        next = code->find(stmt->getLineNumber());
+        break;
+    case IFTHEN: {
+        int left = stmt->getExpression()->eval(context);
+        int right = stmt->getExpression1()->eval(context);
+        if (IfStmt::compare(stmt->getOperator(), left, right)) {
+            if (recording)
+                recorder->record(EV_JUMP, number, stmt->getLineNumber());
+            next = code->find(stmt->getLineNumber());
+        }
+        break;
+    }
+    case END:
+        machine->jump(0);
+        return BEGIN;
+    default:
+        break;
+    }
+    machine->jump(next);
+
+    if (slot >= 0 && (!defined || context.getValue(slot) != was)) {
+        std::string name = stmt->getIdentifierName();
+        var = "`" + name + "` " + (defined ? "changed from " + std::to_string(was) + " to " : "set to ") +
+              std::to_string(context.getValue(slot)) + " at line " + std::to_string(number);
+        paused = true;
+        return PAUSED;
+    }
+    return RUNNING;
+}
+
+void Program::compile() {
+    if (linked != nullptr) {
+        code = linked;
+        linked = nullptr;
+    } else {
+        code = new Bytecode(stmts);
+        // check every jump before running, and show where it fails
+        int bad = code->link();
+        if (bad >= 0) {
+            pc = code->numbers[bad];
+            delete code;
+            code = nullptr;
+            throw RuntimeException("no matching line number");
+        }
+    }
+
+    // reads surely set from here on, and from line 0 after END, need no check
+    int entry = code->find(pc);
+    Dataflow(*code, context, entry).apply(*code);
+
+    machine = new Machine(*code, context);
+    machine->setProfiling(profiling);
+    machine->setRecorder(recording ? recorder : nullptr);
+    starting = true; // a new machine counts from nothing
+    paused = false;
+    machine->jump(entry);
+    patch();
+}
+
+void Program::patch() {
+    for (auto &s : saved)
+        code->code[s.first] = s.second;
+    saved.clear();
+
+    int line = 0, size = code->starts.size();
+    for (auto &stmt : stmts) {
+        bool stop = breaks.count(stmt.first) != 0 ||
+                    (stmt.second->type() == LET && watches.count(stmt.second->getIdentifierName()) != 0);
+        // an empty line shares its start with the next, and is never stopped at
+        int ip = code->starts[line], end = line + 1 < size ? code->starts[line + 1] : code->code.size() - 1;
+        if (stop && ip < end) {
+            saved[ip] = code->code[ip];
+            code->code[ip] = Instruction{OP_BREAK, 0};
+        }
+        line++;
+    }
+    machine->dropTraces();
+}
+
+const Instruction &Program::original(int ip) {
+    auto it = saved.find(ip);
+    return it == saved.end() ? code->code[ip] : it->second;
+}
+
+void Program::discard() {
+    if (machine != nullptr)
+        addProfile(profiled, *code, *machine);
+    delete machine;
+    delete code;
+    machine = nullptr;
+    code = nullptr;
+    saved.clear();
+}
+
+void Program::setVariable(std::string name, int val) {
+    context.setValue(name, val);
+}
+
+void Program::setBreakpoint(int line, const std::string &condition) {
+    Statement *stmt = statement(line);
+    if (stmt == nullptr || stmt->type() == REM)
+        throw RuntimeException("no statement to stop at in line " + std::to_string(line));
+
+    // the condition is parsed as an IF statement, whose test it becomes
+    Breakpoint b{condition, nullptr, nullptr};
+    if (!condition.empty()) {
+        std::string source = "IF " + condition + " THEN " + std::to_string(line);
+        Tokenizer tokenizer(source);
+        b.arena = new Arena;
+        try {
+            b.test = StmtParser(tokenizer, 0, *b.arena).statement;
+        } catch (ParseException &) {
+            delete b.arena;
+            throw;
+        }
+        b.test->resolve(context);
+    }
+    clearBreakpoint(line);
+    breaks[line] = b;
+    if (code != nullptr)
+        patch();
+}
+
+void Program::clearBreakpoint(int line) {
+    auto it = breaks.find(line);
+    if (it == breaks.end())
+        return;
+    delete it->second.arena;
+    breaks.erase(it);
+    if (code != nullptr)
+        patch();
+}
+
+std::map<int, std::string> Program::breakpoints() {
+    std::map<int, std::string> ret;
+    for (auto &b : breaks)
+        ret[b.first] = b.second.condition;
+    return ret;
+}
+
+void Program::setWatchpoint(const std::string &name) {
+    watches.insert(name);
+    if (code != nullptr)
+        patch();
+}
+
+void Program::clearWatchpoint(const std::string &name) {
+    watches.erase(name);
+    if (code != nullptr)
+        patch();
+}
+
+void Program::setLimits(const Limits &limits) {
+    this->limits = limits;
+    starting = true;
+}
+
+void Program::setProfiling(bool on) {
+    profiling = on;
+    if (machine != nullptr)
+        machine->setProfiling(on);
+}
+
+void Program::clearProfile() {
+    profiled.clear();
+    if (machine != nullptr)
+        machine->clearProfile();
+}
+
+std::map<int, LineProfile> Program::profile() {
+    std::map<int, LineProfile> ret = profiled;
+    if (machine != nullptr)
+        addProfile(ret, *code, *machine);
+    return ret;
+}
+
+std::string Program::toProfile(bool sorted) {
+    std::map<int, LineProfile> lines = profile();
+    long long total = 0;
+    for (auto &line : lines)
+        total += line.second.nanos;
+
+    std::vector<std::pair<int, LineProfile>> rows;
+    for (auto &stmt : stmts) {
+        auto it = lines.find(stmt.first);
+        LineProfile counters = it == lines.end() ? LineProfile() : it->second;
+        if (!sorted || counters.hits > 0)
+            rows.emplace_back(stmt.first, counters);
+    }
+    if (sorted) {
+        std::stable_sort(rows.begin(), rows.end(), [](const std::pair<int, LineProfile> &a,
+                                                      const std::pair<int, LineProfile> &b) {
+            if (a.second.nanos != b.second.nanos)
+                return a.second.nanos > b.second.nanos;
+            return a.second.hits > b.second.hits;
+        });
+    }
+
+    std::ostringstream ost;
+    ost << std::setw(12) << "hits" << std::setw(12) << "ms" << std::setw(8) << "%"
+        << std::setw(24) << "taken/not taken" << "  line\n";
+    ost << std::fixed;
+    for (auto &row : rows) {
+        const LineProfile &counters = row.second;
+        Statement *stmt = stmts[row.first];
+        ost << std::setw(12) << counters.hits
+            << std::setw(12) << std::setprecision(3) << counters.nanos / 1e6
+            << std::setw(8) << std::setprecision(1) << (total > 0 ? counters.nanos * 100.0 / total : 0.0);
+        if (stmt->type() == IFTHEN) {
+            std::ostringstream branches;
+            branches << counters.taken << "/" << counters.notTaken;
+            ost << std::setw(24) << branches.str();
+        } else {
+            ost << std::setw(24) << "";
+        }
+        ost << "  " << row.first << " " << stmt->toString() << "\n";
+    }
+    return ost.str();
+}
+
+void Program::setRecording(bool on) {
+    recording = on;
+    if (on && recorder == nullptr)
+        recorder = new Recorder;
+    if (machine != nullptr)
+        machine->setRecorder(on ? recorder : nullptr);
+}
+
+void Program::clearRecording() {
+    delete recorder;
+    recorder = recording ? new Recorder : nullptr;
+    if (machine != nullptr)
+        machine->setRecorder(recorder);
+}
+
+std::string Program::toTrace() {
+    if (recorder == nullptr)
+        return Recorder(1).toJson(context);
+    return recorder->toJson(context);
+}
+
+RuntimeException::RuntimeException(std::string err):
+    err(err) {
+
+}
+
+std::string RuntimeException::what() throw() {
+    return "runtime error: " + err;
+}
@@ -0,0 +1,214 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "exp.h"
+#include "statement.h"
+#include "bytecode.h"
+#include "machine.h"
+#include "recorder.h"
+
+/*
+ * Class: Program
+ * -----------------
+ * This class is a background program, which maintains
+ * the states and order of statements.
+ */
+
+class Program {
+
+private:
+
+    std::map<int, Statement *> stmts;
+    EvaluationContext context;
+
+    /* statements are made either in arenas handed over in bulk,
+     * which are freed as a whole with the program, or in an arena
+     * of their own, which is freed as soon as the line is replaced */
+    std::vector<Arena *> chunks;
+    std::map<int, Arena *> owned;
+
+    /* program counter: current line number that is under execution */
+    int pc;
+
+    /* compiled form of stmts, built on demand and dropped on insert */
+    Bytecode *code;
+    /* linked bytecode of stmts made ahead of a run, by warnings() or
+     * a cache, which the next compile takes instead of compiling */
+    Bytecode *linked;
+    Machine *machine;
+
+    /* whether lines are profiled, and what has been recorded by
+     * machines dropped since the last clearProfile() */
+    bool profiling;
+    std::map<int, LineProfile> profiled;
+
+    /* whether runs are recorded, and the events since the last
+     * clearRecording(), kept across machines */
+    bool recording;
+    Recorder *recorder;
+
+    /* limits of every run, and whether the next run() starts a run */
+    Limits limits;
+    bool starting;
+
+    /* debugging: lines to stop at, each with the IF statement of its
+     * condition if any, and variables to stop at when a LET changes
+     * them.  The lines are stopped at by OP_BREAK patched over their
+     * first instructions, which are kept here, so that the machine
+     * runs as fast as ever when there is nothing to stop at */
+    struct Breakpoint {
+        std::string condition;
+        Arena *arena;
+        Statement *test;
+    };
+    std::map<int, Breakpoint> breaks;
+    std::set<std::string> watches;
+    std::map<int, Instruction> saved;
+    // whether the run is stopped at the start of the current line,
+    // which is to be run on its own when the run goes on
+    bool paused;
+
+    void compile();
+    // get the machine ready for a run or a step
+    void prepare(bool skip);
+    // patch the lines to stop at, after putting back those patched before
+    void patch();
+    // the instruction at ip before it has been patched
+    const Instruction &original(int ip);
+    // run the current line on its own from its tree, and move on to the
+    // next one; PAUSED if it changes a variable watched, with why in var
+    ProgramState pass(std::string &out, std::string &var);
+    // drop the compiled form, keeping its profile
+    void discard();
+
+public:
+
+    Program();
+    ~Program();
+    std::string toString();
+    std::string toTree();
+
+    /* access to single lines */
+
+    // line numbers in order
+    std::vector<int> lineNumbers();
+    // statement at a line, or null if there is none
+    Statement *statement(int line);
+    // line number under execution
+    int currentLine() {return pc;}
+    // go on from the beginning of a line when run next
+    void setCurrentLine(int line);
+    // all the statements, by line number
+    const std::map<int, Statement *> &statements() {return stmts;}
+    // the variables, with the slots statements are resolved to
+    const EvaluationContext &variables() {return context;}
+
+    /* programing method */
+
+    // insert a new statement, taking the arena it is made in if given
+    void insert(int line, Statement *stmt, Arena *own = nullptr);
+    // insert many statements sorted by line number without duplicates,
+    // where a null statement deletes its line as in insert() above,
+    // taking all the arenas they are made in
+    void insert(const std::vector<std::pair<int, Statement *>> &lines, std::vector<Arena *> &arenas);
+    // take the linked bytecode of the statements as they are now,
+    // unpatched and unanalysed, for the next run to start from
+    void adopt(Bytecode *linked);
+    // reads of variables maybe not set yet and lines never reached,
+    // when running from the first line, as warnings in line order
+    std::vector<std::string> warnings();
+    // directly execute a statement
+    ProgramState step(std::string &out, Statement *stmt);
+    // execute until END or INPUT, skip the current line if needed;
+    // a positive slice makes it return RUNNING after that many loops.
+    // Returns PAUSED at a breakpoint or watchpoint, with why in var
+    ProgramState run(std::string &out, std::string &var, bool skip = false, long long slice = 0);
+    // execute the current line only, and return PAUSED before the next
+    ProgramState stepOver(std::string &out, std::string &var);
+
+    /* set the value of a variable directly or during runtime */
+    void setVariable(std::string name, int val);
+
+    /* debugging method */
+
+    // stop before a line, or only when a condition such as `I > 10`
+    // holds; throws ParseException for a bad condition
+    void setBreakpoint(int line, const std::string &condition = std::string());
+    void clearBreakpoint(int line);
+    // conditions of the breakpoints, empty if none, by line number
+    std::map<int, std::string> breakpoints();
+    // stop after a LET changes a variable
+    void setWatchpoint(const std::string &name);
+    void clearWatchpoint(const std::string &name);
+    const std::set<std::string> &watchpoints() {return watches;}
+
+    /* limits of a run, from its start to END or an error */
+    void setLimits(const Limits &limits);
+    const Limits &getLimits() {return limits;}
+
+    /* profiling method */
+
+    // record hits, time and branches of every line from now on or not
+    void setProfiling(bool on);
+    bool isProfiling() {return profiling;}
+    void clearProfile();
+    // what has been recorded, by line number
+    std::map<int, LineProfile> profile();
+    // a listing annotated with the profile, in line order,
+    // or only the lines executed, the slowest first
+    std::string toProfile(bool sorted = false);
+
+    /* recording method */
+
+    // record the lines, jumps, output and INPUT waits of runs from now
+    // on or not, keeping only the last Recorder::CAPACITY events
+    void setRecording(bool on);
+    bool isRecording() {return recording;}
+    void clearRecording();
+    // what has been recorded, as Chrome trace event JSON
+    std::string toTrace();
+
+};
+
+/*
+ * Class: RuntimeException
+ * -----------------
+ * This is a customized exception class used to
+ * handle errors during runtime.
+ */
+
+class RuntimeException {
+
+private:
+
+    std::string err;
+
+public:
+
+    RuntimeException(std::string err);
+    std::string what() throw();
+
+};
+
+/*
+ * Class: LimitException
+ * -----------------
+ * This is the runtime error of a run which has passed one of
+ * its limits, told apart from errors of the program itself.
+ */
+
+class LimitException : public RuntimeException {
+
+public:
+
+    LimitException(std::string err): RuntimeException(err) {}
+
+};
+
+#endif // PROGRAM_H
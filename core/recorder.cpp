@@ -0,0 +1,134 @@
+#include "recorder.h"
+
+#include <cstdio>
+#include <sstream>
+
+// a time in nanoseconds as microseconds, which trace viewers expect
+static std::string micros(long long nanos) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%lld.%03lld", nanos / 1000, nanos % 1000);
+    return buf;
+}
+
+Recorder::Recorder(int capacity):
+    mask(1),
+    head(0),
+    start(std::chrono::steady_clock::now()) {
+    while (mask < (unsigned long long)capacity)
+        mask <<= 1;
+    slots = new Slot[mask];
+    for (unsigned long long i = 0; i < mask; i++)
+        slots[i].seq.store(0, std::memory_order_relaxed);
+    mask--;
+}
+
+Recorder::~Recorder() {
+    delete[] slots;
+}
+
+void Recorder::record(EventKind kind, int line, int value) {
+    long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    unsigned long long n = head.load(std::memory_order_relaxed);
+    Slot &slot = slots[n & mask];
+
+    // odd while the fields are written, readers see it before any of them
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.nanos.store(nanos, std::memory_order_relaxed);
+    slot.kind.store(kind, std::memory_order_relaxed);
+    slot.line.store(line, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+    head.store(n + 1, std::memory_order_release);
+}
+
+std::vector<Event> Recorder::events() const {
+    unsigned long long end = head.load(std::memory_order_acquire);
+    unsigned long long begin = end > mask + 1 ? end - mask - 1 : 0;
+    std::vector<Event> ret;
+    ret.reserve(end - begin);
+    for (unsigned long long n = begin; n < end; n++) {
+        const Slot &slot = slots[n & mask];
+        unsigned long long seq = slot.seq.load(std::memory_order_acquire);
+        if (seq != 2 * n + 2)
+            continue; // overwritten already
+        Event event;
+        event.nanos = slot.nanos.load(std::memory_order_relaxed);
+        event.kind = EventKind(slot.kind.load(std::memory_order_relaxed));
+        event.line = slot.line.load(std::memory_order_relaxed);
+        event.value = slot.value.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == seq)
+            ret.push_back(event);
+    }
+    return ret;
+}
+
+long long Recorder::count() const {
+    return head.load(std::memory_order_acquire);
+}
+
+std::string Recorder::toJson(const EvaluationContext &context) const {
+    std::vector<Event> kept = events();
+    std::ostringstream ost;
+    ost << "{\"traceEvents\":[\n"
+           "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"qbasic\"}}";
+
+    auto span = [&](const Event &from, long long to, const std::string &name, const char *cat) {
+        ost << ",\n{\"name\":\"" << name << "\",\"cat\":\"" << cat << "\",\"ph\":\"X\",\"ts\":" << micros(from.nanos)
+            << ",\"dur\":" << micros(to - from.nanos) << ",\"pid\":1,\"tid\":1,\"args\":{\"line\":" << from.line << "}}";
+    };
+    auto instant = [&](const Event &at, const std::string &name, const char *cat, const std::string &args) {
+        ost << ",\n{\"name\":\"" << name << "\",\"cat\":\"" << cat << "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":"
+            << micros(at.nanos) << ",\"pid\":1,\"tid\":1,\"args\":{" << args << "}}";
+    };
+    auto inputName = [&](const Event &at) {
+        return "INPUT " + (at.value >= 0 && at.value < context.size() ? context.name(at.value) : std::string("?"));
+    };
+
+    // the line and the input being timed, by index into kept, or -1;
+    // the oldest events may have been overwritten in the middle of either
+    int line = -1, input = -1;
+    for (int i = 0; i < (int)kept.size(); i++) {
+        const Event &event = kept[i];
+        if (line >= 0 && (event.kind == EV_LINE || event.kind == EV_INPUT || event.kind == EV_STOP)) {
+            span(kept[line], event.nanos, "line " + std::to_string(kept[line].line), "line");
+            line = -1;
+        }
+        switch (event.kind) {
+        case EV_LINE:
+            line = i;
+            break;
+        case EV_JUMP:
+            instant(event, "jump to " + std::to_string(event.value), "jump",
+                    "\"from\":" + std::to_string(event.line) + ",\"to\":" + std::to_string(event.value));
+            break;
+        case EV_PRINT:
+            instant(event, "PRINT " + std::to_string(event.value), "print",
+                    "\"line\":" + std::to_string(event.line) + ",\"value\":" + std::to_string(event.value));
+            break;
+        case EV_INPUT:
+            input = i;
+            break;
+        case EV_RESUME:
+            if (input >= 0)
+                span(kept[input], event.nanos, inputName(kept[input]), "input");
+            input = -1;
+            break;
+        case EV_STOP:
+            break;
+        }
+    }
+
+    // what is still open ends with the last event
+    long long last = kept.empty() ? 0 : kept.back().nanos;
+    if (line >= 0)
+        span(kept[line], last, "line " + std::to_string(kept[line].line), "line");
+    if (input >= 0)
+        span(kept[input], last, inputName(kept[input]), "input");
+
+    ost << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"recorded\":" << count()
+        << ",\"kept\":" << kept.size() << "}}\n";
+    return ost.str();
+}
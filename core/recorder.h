@@ -0,0 +1,96 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "exp.h"
+
+/*
+ * Type: EventKind
+ * -----------------
+ * This enumerated type is used to describe what happened
+ * at an event recorded during a run.
+ */
+
+enum EventKind {
+    EV_LINE,    // a line is entered
+    EV_JUMP,    // a GOTO or IF jumps to the line in value
+    EV_PRINT,   // the value is printed
+    EV_INPUT,   // the run waits for input of the variable in slot value
+    EV_RESUME,  // the run goes on, after input or from where it stopped
+    EV_STOP     // the run returns for any reason
+};
+
+/*
+ * Type: Event
+ * -----------------
+ * This type is used to hold one event of a run.
+ */
+
+struct Event {
+    long long nanos;     // time since the recorder was made
+    EventKind kind;
+    int line;            // number of the line it happens at
+    int value;
+};
+
+/*
+ * Class: Recorder
+ * -----------------
+ * This class keeps the last events of a run in a ring buffer of
+ * a fixed size, so that the memory taken is bounded however long
+ * the run is.  One thread records without locks, overwriting the
+ * oldest events once the ring is full; any thread may take a copy
+ * at any time.  Each slot holds a sequence number, which is odd
+ * while the slot is written, and a copy is only kept when the
+ * number is the same before and after it, so a slot overwritten
+ * during the copy is left out instead of coming out torn.
+ */
+
+class Recorder {
+
+public:
+
+    // events kept by default, about 8 MB
+    static const int CAPACITY = 1 << 18;
+
+    // keep the last events, capacity rounded up to a power of two
+    explicit Recorder(int capacity = CAPACITY);
+    ~Recorder();
+
+    // add an event now; only one thread may record
+    void record(EventKind kind, int line, int value = 0);
+
+    // the events kept, oldest first
+    std::vector<Event> events() const;
+    // events recorded in all, kept or not
+    long long count() const;
+
+    // the events kept in the Chrome trace event format, which can be
+    // opened by chrome://tracing or Perfetto: every line entered is a
+    // span lasting until the next one or the end of the run, every
+    // wait for input a span until the run resumes, and jumps and
+    // values printed are instants.  Names of variables come from the
+    // context the slots belong to
+    std::string toJson(const EvaluationContext &context) const;
+
+private:
+
+    struct Slot {
+        std::atomic<unsigned long long> seq;
+        std::atomic<long long> nanos;
+        std::atomic<int> kind, line, value;
+    };
+
+    Slot *slots;
+    unsigned long long mask;
+    /* events recorded so far, the next goes to slots[head & mask] */
+    std::atomic<unsigned long long> head;
+    std::chrono::steady_clock::time_point start;
+
+};
+
+#endif // RECORDER_H
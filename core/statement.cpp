@@ -3,17 +3,17 @@
 #include <iostream>
 #include <sstream>
 
-RemStmt::RemStmt(std::string content):
+RemStmt::RemStmt(const char *content):
     content(content) {
 
 }
 
 std::string RemStmt::toString() {
-    return "REM " + content;
+    return "REM " + std::string(content);
 }
 
 std::string RemStmt::toTree() {
-    return "REM\n    " + content + "\n";
+    return "REM\n    " + std::string(content) + "\n";
 }
 
 StatementType RemStmt::type() {
@@ -28,24 +28,21 @@ std::string RemStmt::getContent() {
     return content;
 }
 
-LetStmt::LetStmt(std::string name, Expression *exp):
+LetStmt::LetStmt(const char *name, Expression *exp):
     name(name),
+    slot(-1),
     exp(exp) {
 
 }
 
-LetStmt::~LetStmt() {
-    delete exp;
-}
-
 std::string LetStmt::toString() {
     std::string exp_str = exp ? exp->toString() : "";
-    return "LET " + name + " = " + exp_str;
+    return "LET " + std::string(name) + " = " + exp_str;
 }
 
 std::string LetStmt::toTree() {
     std::string exp_tree = exp ? exp->toTree(1) : "\n";
-    return "LET =\n    " + name + "\n" + exp_tree;
+    return "LET =\n    " + std::string(name) + "\n" + exp_tree;
 }
 
 std::string LetStmt::usage() {
@@ -56,10 +53,19 @@ StatementType LetStmt::type() {
     return LET;
 }
 
+void LetStmt::resolve(EvaluationContext &context) {
+    slot = context.slot(name);
+    exp->resolve(context);
+}
+
 std::string LetStmt::getIdentifierName() {
     return name;
 }
 
+int LetStmt::getSlot() {
+    return slot;
+}
+
 Expression *LetStmt::getExpression() {
     return exp;
 }
@@ -69,10 +75,6 @@ PrintStmt::PrintStmt(Expression *exp):
 
 }
 
-PrintStmt::~PrintStmt() {
-    delete exp;
-}
-
 std::string PrintStmt::toString() {
     std::string exp_str = exp ? exp->toString() : "";
     return "PRINT " + exp_str;
@@ -91,22 +93,27 @@ StatementType PrintStmt::type() {
     return PRINT;
 }
 
+void PrintStmt::resolve(EvaluationContext &context) {
+    exp->resolve(context);
+}
+
 Expression *PrintStmt::getExpression() {
     return exp;
 }
 
-InputStmt::InputStmt(std::string name):
+InputStmt::InputStmt(const char *name):
     done(false),
-    name(name) {
+    name(name),
+    slot(-1) {
 
 }
 
 std::string InputStmt::toString() {
-    return "INPUT " + name;
+    return "INPUT " + std::string(name);
 }
 
 std::string InputStmt::toTree() {
-    return "INPUT\n    " + name + "\n";
+    return "INPUT\n    " + std::string(name) + "\n";
 }
 
 StatementType InputStmt::type() {
@@ -117,10 +124,18 @@ std::string InputStmt::usage() {
     return "usage: INPUT <varname>";
 }
 
+void InputStmt::resolve(EvaluationContext &context) {
+    slot = context.slot(name);
+}
+
 std::string InputStmt::getIdentifierName() {
     return name;
 }
 
+int InputStmt::getSlot() {
+    return slot;
+}
+
 GotoStmt::GotoStmt(int number):
     number(number) {
 
@@ -150,7 +165,7 @@ std::string GotoStmt::usage() {
     return "usage: GOTO <linenumber>";
 }
 
-IfStmt::IfStmt(Expression *exp, std::string op, Expression *exp1, int number):
+IfStmt::IfStmt(Expression *exp, Comparator op, Expression *exp1, int number):
     exp(exp),
     op(op),
     exp1(exp1),
@@ -158,16 +173,29 @@ IfStmt::IfStmt(Expression *exp, std::string op, Expression *exp1, int number):
 
 }
 
-IfStmt::~IfStmt() {
-    delete exp;
-    delete exp1;
+std::string IfStmt::name(Comparator op) {
+    switch (op) {
+    case LESS: return "<";
+    case GREATER: return ">";
+    case EQUAL: return "=";
+    }
+    return "";
+}
+
+bool IfStmt::compare(Comparator op, int left, int right) {
+    switch (op) {
+    case LESS: return left < right;
+    case GREATER: return left > right;
+    case EQUAL: return left == right;
+    }
+    return false;
 }
 
 std::string IfStmt::toString() {
     std::ostringstream ost;
     std::string exp_str = exp ? exp->toString() : "";
     std::string exp1_str = exp1 ? exp1->toString() : "";
-    ost << "IF " << exp_str << " " << op << " " << exp1_str << " THEN " << number;
+    ost << "IF " << exp_str << " " << name(op) << " " << exp1_str << " THEN " << number;
     return ost.str();
 }
 
@@ -175,7 +203,7 @@ std::string IfStmt::toTree() {
     std::string exp_tree = exp ? exp->toTree(1) : "\n";
     std::string exp1_tree = exp1 ? exp1->toTree(1) : "\n";
     std::ostringstream ost;
-    ost << "IF THEN\n" << exp_tree << "    " << op << "\n"
+    ost << "IF THEN\n" << exp_tree << "    " << name(op) << "\n"
         << exp1_tree << "    " << number << "\n";
     return ost.str();
 }
@@ -188,11 +216,16 @@ StatementType IfStmt::type() {
     return IFTHEN;
 }
 
+void IfStmt::resolve(EvaluationContext &context) {
+    exp->resolve(context);
+    exp1->resolve(context);
+}
+
 Expression *IfStmt::getExpression() {
     return exp;
 }
 
-std::string IfStmt::getOperator() {
+Comparator IfStmt::getOperator() {
     return op;
 }
 
@@ -14,6 +14,15 @@
 
 enum StatementType { REM, LET, PRINT, INPUT, GOTO, IFTHEN, END };
 
+/*
+ * Type: Comparator
+ * --------------------
+ * This enumerated type is used to differentiate the 3 comparation
+ * operators of IF statements: <, > and =.
+ */
+
+enum Comparator { LESS, GREATER, EQUAL };
+
 /*
  * Class: Statement
  * -----------------
@@ -21,6 +30,8 @@ enum StatementType { REM, LET, PRINT, INPUT, GOTO, IFTHEN, END };
  * Statement itself is an abstract class.  Every Statement object
  * is therefore created using one of the 7 concrete subclasses:
  * RemStmt, LetStmt, PrintStmt, InputStmt, GotoStmt, IfStmt and EndStmt.
+ * Like expressions, statements are made in an Arena, and the strings
+ * they are given must live as long as they do.
  */
 
 class Statement {
@@ -28,18 +39,21 @@ class Statement {
 public:
 
     Statement() {}
-    virtual ~Statement() {}
     virtual std::string toString() = 0;
     virtual std::string toTree() = 0;
     virtual StatementType type() = 0;
 
+    /* bind variables to the slots of a context */
+    virtual void resolve(EvaluationContext &) {}
+
 /* Getter methods for convenience */
 
     virtual std::string getContent() {return "";}
     virtual std::string getIdentifierName() {return "";}
+    virtual int getSlot() {return -1;}
     virtual Expression * getExpression() {return nullptr;}
     virtual int getLineNumber() {return -1;}
-    virtual std::string getOperator() {return "";}
+    virtual Comparator getOperator() {return EQUAL;}
     virtual Expression * getExpression1() {return nullptr;}
 
 };
@@ -54,7 +68,7 @@ class RemStmt: public Statement {
 
 public:
 
-    RemStmt(std::string content);
+    RemStmt(const char *content);
     static std::string usage();
 
     virtual std::string toString() override;
@@ -65,7 +79,7 @@ public:
 
 private:
 
-    std::string content;
+    const char *content;
 
 };
 
@@ -79,20 +93,23 @@ class LetStmt: public Statement {
 
 public:
 
-    LetStmt(std::string name, Expression *exp);
-    ~LetStmt();
+    LetStmt(const char *name, Expression *exp);
     static std::string usage();
 
     virtual std::string toString() override;
     virtual std::string toTree() override;
     virtual StatementType type() override;
 
+    virtual void resolve(EvaluationContext &context) override;
+
     virtual std::string getIdentifierName() override;
+    virtual int getSlot() override;
     virtual Expression * getExpression() override;
 
 private:
 
-    std::string name;
+    const char *name;
+    int slot;
     Expression *exp;
 
 };
@@ -108,13 +125,14 @@ class PrintStmt: public Statement {
 public:
 
     PrintStmt(Expression *exp);
-    ~PrintStmt();
     static std::string usage();
 
     virtual std::string toString() override;
     virtual std::string toTree() override;
     virtual StatementType type() override;
 
+    virtual void resolve(EvaluationContext &context) override;
+
     virtual Expression * getExpression() override;
 
 private:
@@ -136,18 +154,22 @@ public:
     // whether this variable is set
     bool done;
 
-    InputStmt(std::string name);
+    InputStmt(const char *name);
     static std::string usage();
 
     virtual std::string toString() override;
     virtual std::string toTree() override;
     virtual StatementType type() override;
 
+    virtual void resolve(EvaluationContext &context) override;
+
     virtual std::string getIdentifierName() override;
+    virtual int getSlot() override;
 
 private:
 
-    std::string name;
+    const char *name;
+    int slot;
 
 };
 
@@ -186,23 +208,29 @@ class IfStmt: public Statement {
 
 public:
 
-    IfStmt(Expression *exp, std::string op, Expression *exp1, int number);
-    ~IfStmt();
+    IfStmt(Expression *exp, Comparator op, Expression *exp1, int number);
     static std::string usage();
 
+    // the symbol of a comparator
+    static std::string name(Comparator op);
+    // compare two values with a comparator
+    static bool compare(Comparator op, int left, int right);
+
     virtual std::string toString() override;
     virtual std::string toTree() override;
     virtual StatementType type() override;
 
+    virtual void resolve(EvaluationContext &context) override;
+
     virtual Expression * getExpression() override;
-    virtual std::string getOperator() override;
+    virtual Comparator getOperator() override;
     virtual Expression * getExpression1() override;
     virtual int getLineNumber() override;
 
 private:
 
     Expression *exp;
-    std::string op;
+    Comparator op;
     Expression *exp1;
     int number;
 
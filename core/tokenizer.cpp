@@ -0,0 +1,121 @@
+#include "tokenizer.h"
+
+#include <climits>
+#include <cstring>
+
+bool Tokenizer::isDelim(char c) {
+    switch (c) {
+    case ' ': case '+': case '-': case '*': case '/':
+    case '<': case '>': case '=': case '(': case ')':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool Tokenizer::isLetter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '&';
+}
+
+bool Tokenizer::isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+Tokenizer::Tokenizer(const std::string &str):
+    source(nullptr) {
+    scan(str.data(), str.data() + str.size());
+}
+
+Tokenizer::Tokenizer(const char *begin, const char *end):
+    source(nullptr) {
+    scan(begin, end);
+}
+
+void Tokenizer::scan(const char *begin, const char *end) {
+    const char *p = begin, *q;
+    source = begin;
+    tokens.clear();
+
+    while (p < end) {
+        switch (*p) {
+        case ' ': p++; break;
+        case '+': push(T_PLUS, p++, 1); break;
+        case '-': push(T_MINUS, p++, 1); break;
+        case '/': push(T_DIVIDE, p++, 1); break;
+        case '<': push(T_LESS, p++, 1); break;
+        case '>': push(T_GREATER, p++, 1); break;
+        case '=': push(T_EQUAL, p++, 1); break;
+        case '(': push(T_LPAREN, p++, 1); break;
+        case ')': push(T_RPAREN, p++, 1); break;
+        case '*':
+            if (p + 1 < end && p[1] == '*') { // `**`
+                push(T_POWER, p, 2);
+                p += 2;
+            } else { // single `*`
+                push(T_TIMES, p++, 1);
+            }
+            break;
+        default:
+            for (q = p; q < end && !isDelim(*q); q++);
+            word(p, q - p);
+            p = q;
+        }
+    }
+}
+
+void Tokenizer::push(TokenKind kind, const char *begin, int length) {
+    tokens.push_back({kind, false, (int)(begin - source), length, 0});
+}
+
+void Tokenizer::word(const char *begin, int length) {
+    const char *end = begin + length, *p;
+
+    // a number: digits only
+    if (isDigit(*begin)) {
+        long long value = 0;
+        for (p = begin; p < end && isDigit(*p); p++)
+            if (value <= INT_MAX)
+                value = value * 10 + (*p - '0');
+        if (p < end) {
+            push(T_ILLEGAL, begin, length);
+            return;
+        }
+        push(T_NUMBER, begin, length);
+        tokens.back().overflow = value > INT_MAX;
+        tokens.back().value = value > INT_MAX ? INT_MAX : (int)value;
+        return;
+    }
+
+    // a name: a letter followed by letters and digits
+    if (!isLetter(*begin)) {
+        push(T_ILLEGAL, begin, length);
+        return;
+    }
+    for (p = begin + 1; p < end; p++) {
+        if (!isLetter(*p) && !isDigit(*p)) {
+            push(T_ILLEGAL, begin, length);
+            return;
+        }
+    }
+
+    static const struct { const char *word; TokenKind kind; } keywords[] = {
+        {"REM", T_REM}, {"LET", T_LET}, {"PRINT", T_PRINT}, {"INPUT", T_INPUT},
+        {"GOTO", T_GOTO}, {"IF", T_IF}, {"THEN", T_THEN}, {"END", T_END}
+    };
+    for (auto &k : keywords) {
+        if ((int)std::strlen(k.word) == length && std::memcmp(k.word, begin, length) == 0) {
+            push(k.kind, begin, length);
+            return;
+        }
+    }
+    push(T_NAME, begin, length);
+}
+
+std::string Tokenizer::text(int i) const {
+    return std::string(source + tokens[i].offset, tokens[i].length);
+}
+
+bool Tokenizer::is(int i, const char *word) const {
+    const Token &t = tokens[i];
+    return (int)std::strlen(word) == t.length && std::memcmp(word, source + t.offset, t.length) == 0;
+}
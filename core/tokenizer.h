@@ -0,0 +1,82 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <string>
+#include <vector>
+
+/*
+ * Type: TokenKind
+ * -----------------
+ * This enumerated type is used to classify tokens.
+ * Keywords of statements are names as well, so that they
+ * can still be used as variables.
+ */
+
+enum TokenKind : unsigned char {
+    T_NUMBER, T_NAME,
+    /* keywords */
+    T_REM, T_LET, T_PRINT, T_INPUT, T_GOTO, T_IF, T_THEN, T_END,
+    /* operators */
+    T_PLUS, T_MINUS, T_TIMES, T_DIVIDE, T_POWER, T_LPAREN, T_RPAREN,
+    T_LESS, T_GREATER, T_EQUAL,
+    /* anything else, such as `2x` or `$` */
+    T_ILLEGAL
+};
+
+/*
+ * Type: Token
+ * -----------------
+ * This type is used to define token.  A token does not hold
+ * its text, but refers to it in the source being tokenized.
+ * The value of a number is parsed once, saturated at INT_MAX.
+ */
+
+struct Token {
+    TokenKind kind;
+    bool overflow;  // whether a number does not fit an int
+    int offset;
+    int length;
+    int value;
+};
+
+/*
+ * Class: Tokenizer
+ * -----------------
+ * This class is used to split strings into tokens.
+ * The source must outlive the tokenizer.
+ */
+
+class Tokenizer {
+
+public:
+
+    /* some tools for parsing tokens */
+    /* delimitations for a string, including operators */
+    static inline bool isDelim(char c);
+    static inline bool isLetter(char c);
+    static inline bool isDigit(char c);
+
+public:
+
+    Tokenizer(const std::string &str);
+    Tokenizer(const char *begin, const char *end);
+
+    // tokenize another source, reusing the storage of tokens
+    void scan(const char *begin, const char *end);
+
+    // the text of a token
+    std::string text(int i) const;
+    // whether the text of a token is the given word
+    bool is(int i, const char *word) const;
+
+    const char *source;
+    std::vector<Token> tokens;
+
+private:
+
+    void push(TokenKind kind, const char *begin, int length);
+    void word(const char *begin, int length);
+
+};
+
+#endif // TOKENIZER_H
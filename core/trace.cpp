@@ -0,0 +1,272 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <map>
+
+/* most instructions followed while recording, longer loops are not traced */
+static const int MAX_LENGTH = 256;
+
+Trace::Trace(const Bytecode &code, const EvaluationContext &context, int head):
+    recorded(false),
+    head(head),
+    jumps(0),
+    length(0),
+    bound(nullptr) {
+    std::vector<std::pair<int, bool>> path;
+    if (!record(code, context, path))
+        return;
+    compile(code, path);
+    length = path.size();
+    recorded = true;
+}
+
+bool Trace::record(const Bytecode &code, const EvaluationContext &context,
+                   std::vector<std::pair<int, bool>> &path) {
+    std::vector<int> values(context.size());
+    std::vector<bool> defined(context.size());
+    for (int slot = 0; slot < context.size(); slot++) {
+        values[slot] = context.getValue(slot);
+        defined[slot] = context.isDefined(slot);
+    }
+
+    std::vector<int> stack;
+    int ip = head, lhs, rhs, next;
+    bool taken;
+    for (int n = 0; n < MAX_LENGTH; n++, ip = next) {
+        const Instruction &i = code.code[ip];
+        path.emplace_back(ip, false);
+        next = ip + 1;
+
+        switch (i.op) {
+        case OP_CONST:
+            stack.push_back(i.arg);
+            continue;
+        case OP_LOAD:
+        case OP_LOAD_UNCHECKED:
+            if (!defined[i.arg])
+                return false; // fails here, let the machine report it
+            stack.push_back(values[i.arg]);
+            continue;
+        case OP_STORE:
+            values[i.arg] = stack.back();
+            defined[i.arg] = true;
+            stack.pop_back();
+            continue;
+        case OP_PRINT:
+            stack.pop_back();
+            continue;
+        case OP_INPUT:
+        case OP_END:
+        case OP_BREAK:
+            return false;
+        case OP_GOTO:
+            taken = true;
+            break;
+        case OP_IFLT:
+        case OP_IFGT:
+        case OP_IFEQ:
+            rhs = stack.back();
+            stack.pop_back();
+            lhs = stack.back();
+            stack.pop_back();
+            taken = i.op == OP_IFLT ? lhs < rhs : i.op == OP_IFGT ? lhs > rhs : lhs == rhs;
+            path.back().second = taken;
+            break;
+        default: // arithmetic
+            lhs = stack.back();
+            stack.pop_back();
+            rhs = stack.back();
+            if (i.op == OP_DIV && rhs == 0)
+                return false;
+            stack.back() = CompoundExp::apply(i.op == OP_ADD ? PLUS : i.op == OP_SUB ? MINUS :
+                                              i.op == OP_MUL ? TIMES : i.op == OP_DIV ? DIVIDE : POWER,
+                                              lhs, rhs);
+            continue;
+        }
+
+        // a jump, the loop is closed when it goes back to the head
+        if (taken) {
+            next = i.arg;
+            if (next <= ip)
+                jumps++;
+        }
+        if (next == head)
+            return true;
+    }
+    return false;
+}
+
+int Trace::cell(int value) {
+    cells.push_back(value);
+    return ~(int)(cells.size() - 1);
+}
+
+void Trace::emit(TraceCode code, int d, int a, int b, int exit) {
+    steps.push_back({code, d, a, b, exit});
+}
+
+void Trace::compile(const Bytecode &code, const std::vector<std::pair<int, bool>> &path) {
+    std::map<int, int> constants;
+    std::vector<int> temporaries; // cell for each depth of the stack
+    std::vector<int> stack;       // operands on the stack, as in a step
+
+    for (auto &p : path) {
+        int ip = p.first;
+        const Instruction &i = code.code[ip];
+        int depth = stack.size(), a, b;
+        TraceCode op;
+
+        switch (i.op) {
+        case OP_CONST:
+            if (constants.count(i.arg) == 0)
+                constants[i.arg] = cell(i.arg);
+            stack.push_back(constants[i.arg]);
+            continue;
+        case OP_LOAD:
+        case OP_LOAD_UNCHECKED:
+            stack.push_back(i.arg);
+            slots.push_back(i.arg);
+            continue;
+        case OP_STORE:
+            a = stack.back();
+            stack.pop_back();
+            slots.push_back(i.arg);
+            // the step making a temporary can store into the variable itself
+            if (a < 0 && !steps.empty() && steps.back().d == a && steps.back().code <= TR_POW)
+                steps.back().d = i.arg;
+            else
+                emit(TR_MOVE, i.arg, a, 0);
+            continue;
+        case OP_PRINT:
+            emit(TR_PRINT, 0, stack.back(), 0);
+            stack.pop_back();
+            continue;
+        case OP_GOTO:
+            continue;
+        case OP_IFLT:
+        case OP_IFGT:
+        case OP_IFEQ:
+            b = stack.back();
+            stack.pop_back();
+            a = stack.back();
+            stack.pop_back();
+            if (i.op == OP_IFLT)
+                op = p.second ? TR_IFLT : TR_IFGE;
+            else if (i.op == OP_IFGT)
+                op = p.second ? TR_IFGT : TR_IFLE;
+            else
+                op = p.second ? TR_IFEQ : TR_IFNE;
+            // leave to where the jump would have gone the other way
+            emit(op, 0, a, b, p.second ? ip + 1 : i.arg);
+            continue;
+        case OP_ADD: op = TR_ADD; break;
+        case OP_SUB: op = TR_SUB; break;
+        case OP_MUL: op = TR_MUL; break;
+        case OP_DIV: op = TR_DIV; break;
+        case OP_POW: op = TR_POW; break;
+        default:
+            continue; // never recorded
+        }
+
+        // arithmetic: the left operand is on top, the result replaces both
+        a = stack.back();
+        stack.pop_back();
+        b = stack.back();
+        stack.pop_back();
+        while ((int)temporaries.size() < depth - 1)
+            temporaries.push_back(cell(0));
+        int d = temporaries[depth - 2];
+        // a division by zero leaves at the start of its line, which fails again there
+        emit(op, d, a, b, code.starts[code.lineOf(ip)]);
+        stack.push_back(d);
+    }
+    emit(TR_LOOP, 0, 0, 0, head);
+
+    std::sort(slots.begin(), slots.end());
+    slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+    ops.resize(steps.size());
+}
+
+void Trace::bind(int *values) {
+    bound = values;
+    auto at = [&](int ref) {
+        return ref >= 0 ? values + ref : cells.data() + ~ref;
+    };
+    for (std::size_t k = 0; k < steps.size(); k++) {
+        const Step &s = steps[k];
+        ops[k] = {s.code, at(s.d), at(s.a), at(s.b), s.exit};
+    }
+}
+
+int Trace::run(EvaluationContext &context, std::string &out, long long &slice, long long &fuel) {
+    for (int slot : slots) {
+        if (!context.isDefined(slot))
+            return head;
+    }
+    // a program without variables has no memory, and is bound each time
+    if (bound != context.data() || bound == nullptr)
+        bind(context.data());
+
+    const Op *op = ops.data();
+    for (;;) {
+        switch (op->code) {
+        case TR_MOVE:
+            *op->d = *op->a;
+            break;
+        case TR_ADD:
+            *op->d = *op->a + *op->b;
+            break;
+        case TR_SUB:
+            *op->d = *op->a - *op->b;
+            break;
+        case TR_MUL:
+            *op->d = *op->a * *op->b;
+            break;
+        case TR_DIV:
+            if (*op->b == 0)
+                return op->exit;
+            *op->d = *op->a / *op->b;
+            break;
+        case TR_POW:
+            *op->d = CompoundExp::power(*op->a, *op->b);
+            break;
+        case TR_PRINT:
+            if (!out.empty())
+                out += '\n';
+            out += std::to_string(*op->a);
+            break;
+        case TR_IFLT:
+            if (!(*op->a < *op->b))
+                return op->exit;
+            break;
+        case TR_IFGE:
+            if (*op->a < *op->b)
+                return op->exit;
+            break;
+        case TR_IFGT:
+            if (!(*op->a > *op->b))
+                return op->exit;
+            break;
+        case TR_IFLE:
+            if (*op->a > *op->b)
+                return op->exit;
+            break;
+        case TR_IFEQ:
+            if (*op->a != *op->b)
+                return op->exit;
+            break;
+        case TR_IFNE:
+            if (*op->a == *op->b)
+                return op->exit;
+            break;
+        case TR_LOOP:
+            slice -= jumps;
+            fuel -= length;
+            if (slice <= 0 || fuel < 0)
+                return head;
+            op = ops.data();
+            continue;
+        }
+        op++;
+    }
+}
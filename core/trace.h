@@ -0,0 +1,104 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <vector>
+
+#include "exp.h"
+#include "bytecode.h"
+
+/*
+ * Type: TraceCode
+ * -----------------
+ * This enumerated type is used to describe the steps of a trace.
+ * A step works on variables and cells of the trace directly, so
+ * a whole expression like `I + 1` stored into I is one step.
+ * Conditional jumps become guards, which leave the trace when the
+ * condition does not go the way it went when it was recorded.
+ */
+
+enum TraceCode {
+    TR_MOVE,    // d = a
+    TR_ADD,     // d = a + b
+    TR_SUB,     // d = a - b
+    TR_MUL,     // d = a * b
+    TR_DIV,     // d = a / b, leaves if b is 0
+    TR_POW,     // d = a ** b
+    TR_PRINT,   // print a
+    TR_IFLT,    // leaves unless a < b
+    TR_IFGE,    // leaves if a < b
+    TR_IFGT,    // leaves unless a > b
+    TR_IFLE,    // leaves if a > b
+    TR_IFEQ,    // leaves unless a = b
+    TR_IFNE,    // leaves if a = b
+    TR_LOOP     // back to the first step
+};
+
+/*
+ * Class: Trace
+ * -----------------
+ * This class is the path of one iteration of a hot loop.
+ * It is recorded by running the bytecode from the head of the
+ * loop on a copy of the variables, following the jumps as they
+ * go, until the head is reached again.  The path is then turned
+ * into straight-line steps, which run over and over without any
+ * dispatch on jumps or line lookups, until a guard fails.
+ */
+
+class Trace {
+
+public:
+
+    Trace(const Bytecode &code, const EvaluationContext &context, int head);
+
+    // run the loop until a step leaves it, the slice is used up or
+    // the fuel runs out, each iteration taking the instructions it
+    // stands for; returns the instruction index where the machine goes on
+    int run(EvaluationContext &context, std::string &out, long long &slice, long long &fuel);
+
+    // whether a closed loop has been found from the head
+    bool recorded;
+
+private:
+
+    /* a step refers to a variable by its slot, and to a cell
+     * of the trace, a constant or a temporary, by ~index */
+    struct Step {
+        TraceCode code;
+        int d, a, b;
+        int exit;
+    };
+
+    /* a step with its operands bound to memory */
+    struct Op {
+        TraceCode code;
+        int *d, *a, *b;
+        int exit;
+    };
+
+    // follow one iteration from the head, returns the instructions run
+    // and for conditional jumps whether they have jumped
+    bool record(const Bytecode &code, const EvaluationContext &context,
+                std::vector<std::pair<int, bool>> &path);
+    // turn the path into steps
+    void compile(const Bytecode &code, const std::vector<std::pair<int, bool>> &path);
+    int cell(int value);
+    void emit(TraceCode code, int d, int a, int b, int exit = 0);
+    // bind the operands to the variables of a context
+    void bind(int *values);
+
+    int head;
+    // backward jumps and bytecode instructions in one iteration
+    int jumps;
+    int length;
+
+    std::vector<Step> steps;
+    std::vector<Op> ops;
+    std::vector<int> cells;
+    // variables touched, which must all be defined to enter
+    std::vector<int> slots;
+    int *bound;
+
+};
+
+#endif // TRACE_H
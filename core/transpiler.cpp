@@ -0,0 +1,227 @@
+#include "transpiler.h"
+#include "dataflow.h"
+
+#include <climits>
+#include <cstdio>
+#include <sstream>
+
+/* runtime support put ahead of every translated program */
+static const char *const PRELUDE =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#ifdef _WIN32\n"
+    "#include <io.h>\n"
+    "#define isatty _isatty\n"
+    "#define fileno _fileno\n"
+    "#else\n"
+    "#include <unistd.h>\n"
+    "#endif\n"
+    "\n"
+    "static void fail(const char *err) {\n"
+    "    fflush(stdout);\n"
+    "    fprintf(stderr, \"runtime error: %s\\n\", err);\n"
+    "    exit(1);\n"
+    "}\n"
+    "\n"
+    "/* arithmetic wraps around as on the machine */\n"
+    "static int add(int l, int r) { return (int)((unsigned)l + (unsigned)r); }\n"
+    "static int sub(int l, int r) { return (int)((unsigned)l - (unsigned)r); }\n"
+    "static int mul(int l, int r) { return (int)((unsigned)l * (unsigned)r); }\n"
+    "static int power(int l, int r) {\n"
+    "    unsigned v = r < 0 ? 0 : 1;\n"
+    "    while (r-- > 0)\n"
+    "        v *= (unsigned)l;\n"
+    "    return (int)v;\n"
+    "}\n"
+    "\n"
+    "/* read an int as std::cin does, failing on anything else */\n"
+    "static int input(const char *name, const char *err) {\n"
+    "    long long n = 0;\n"
+    "    int c, negative = 0, digits = 0;\n"
+    "    fflush(stdout);\n"
+    "    if (isatty(fileno(stdin)))\n"
+    "        fprintf(stderr, \"%s ? \", name);\n"
+    "    do\n"
+    "        c = getchar();\n"
+    "    while (c == ' ' || c == '\\t' || c == '\\n' || c == '\\r' || c == '\\v' || c == '\\f');\n"
+    "    if (c == '+' || c == '-') {\n"
+    "        negative = c == '-';\n"
+    "        c = getchar();\n"
+    "    }\n"
+    "    for (; c >= '0' && c <= '9'; c = getchar(), digits++)\n"
+    "        if (n <= 2147483648LL)\n"
+    "            n = n * 10 + (c - '0');\n"
+    "    if (c != EOF)\n"
+    "        ungetc(c, stdin);\n"
+    "    if (negative)\n"
+    "        n = -n;\n"
+    "    if (digits == 0 || n < -2147483647LL - 1 || n > 2147483647LL)\n"
+    "        fail(err);\n"
+    "    return (int)n;\n"
+    "}\n"
+    "\n";
+
+// a C string literal of the given text
+static std::string quote(const std::string &text) {
+    std::string ret = "\"";
+    char buf[8];
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\' || c == '?') {
+            ret += '\\';
+            ret += c;
+        } else if (c < 0x20 || c >= 0x7f) {
+            std::snprintf(buf, sizeof(buf), "\\%03o", c);
+            ret += buf;
+        } else {
+            ret += c;
+        }
+    }
+    return ret + "\"";
+}
+
+// a C comment of the given text
+static std::string comment(const std::string &text) {
+    std::string ret = "/* ";
+    for (char c : text) {
+        if (c == '/' && !ret.empty() && ret.back() == '*')
+            ret += ' ';
+        ret += c;
+    }
+    return ret + " */";
+}
+
+// a C literal of an int, INT_MIN can not be written directly
+static std::string literal(int value) {
+    if (value == INT_MIN)
+        return "(-2147483647 - 1)";
+    return std::to_string(value);
+}
+
+// label of the line starting at an instruction
+static std::string label(const Bytecode &code, int ip) {
+    return "L" + std::to_string(code.numbers[code.lineOf(ip)]);
+}
+
+Transpiler::Transpiler(Program &program) {
+    const EvaluationContext &context = program.variables();
+    Bytecode code(program.statements());
+    std::ostringstream ost;
+    ost << "/* translated from a BASIC program */\n" << PRELUDE;
+
+    // a jump to a missing line fails as soon as the program runs
+    if (code.link() >= 0) {
+        ost << "int main(void) {\n"
+            << "    fail(\"no matching line number\");\n"
+            << "    return 1;\n"
+            << "}\n";
+        source = ost.str();
+        return;
+    }
+    Dataflow(code, context).apply(code);
+
+    ost << "int main(void) {\n";
+    for (int slot = 0; slot < context.size(); slot++) {
+        bool defined = context.isDefined(slot);
+        ost << "    int v" << slot << " = " << (defined ? literal(context.getValue(slot)) : "0")
+            << "; char d" << slot << " = " << defined << "; "
+            << comment(context.name(slot)) << "\n";
+    }
+    if (code.depth > 0) {
+        ost << "    int s0";
+        for (int i = 1; i <= code.depth; i++)
+            ost << ", s" << i;
+        ost << ";\n";
+    }
+
+    // a label for every instruction a jump goes to
+    std::vector<bool> targets(code.code.size(), false);
+    for (const Instruction &i : code.code) {
+        if (i.op == OP_GOTO || i.op == OP_IFLT || i.op == OP_IFGT || i.op == OP_IFEQ)
+            targets[i.arg] = true;
+    }
+
+    const std::map<int, Statement *> &stmts = program.statements();
+    int line = 0, depth = 0;
+    for (int ip = 0; ip < (int)code.code.size(); ip++) {
+        // every line starts with an empty stack, empty lines share the start
+        for (; line < (int)code.starts.size() && code.starts[line] == ip; line++) {
+            int number = code.numbers[line];
+            ost << "\n    " << comment(std::to_string(number) + " " + stmts.at(number)->toString()) << "\n";
+            depth = 0;
+        }
+        if (targets[ip])
+            ost << label(code, ip) << ":\n";
+
+        const Instruction &i = code.code[ip];
+        std::string top = "s" + std::to_string(depth - 1);
+        std::string next = "s" + std::to_string(depth - 2);
+        switch (i.op) {
+        case OP_CONST:
+            ost << "    s" << depth++ << " = " << literal(i.arg) << ";\n";
+            break;
+        case OP_LOAD:
+            ost << "    if (!d" << i.arg << ") fail("
+                << quote("`" + context.name(i.arg) + "` is not declared") << ");\n"
+                << "    s" << depth++ << " = v" << i.arg << ";\n";
+            break;
+        case OP_LOAD_UNCHECKED:
+            ost << "    s" << depth++ << " = v" << i.arg << ";\n";
+            break;
+        case OP_ADD:
+            ost << "    " << next << " = add(" << top << ", " << next << ");\n";
+            depth--;
+            break;
+        case OP_SUB:
+            ost << "    " << next << " = sub(" << top << ", " << next << ");\n";
+            depth--;
+            break;
+        case OP_MUL:
+            ost << "    " << next << " = mul(" << top << ", " << next << ");\n";
+            depth--;
+            break;
+        case OP_DIV:
+            ost << "    if (" << next << " == 0) fail(\"divide by zero\");\n"
+                << "    " << next << " = " << top << " / " << next << ";\n";
+            depth--;
+            break;
+        case OP_POW:
+            ost << "    " << next << " = power(" << top << ", " << next << ");\n";
+            depth--;
+            break;
+        case OP_STORE:
+            ost << "    v" << i.arg << " = " << top << "; d" << i.arg << " = 1;\n";
+            depth--;
+            break;
+        case OP_PRINT:
+            ost << "    printf(\"%d\\n\", " << top << ");\n";
+            depth--;
+            break;
+        case OP_INPUT:
+            ost << "    v" << i.arg << " = input(" << quote(context.name(i.arg)) << ", "
+                << quote("no input for `" + context.name(i.arg) + "`") << "); d" << i.arg << " = 1;\n";
+            break;
+        case OP_GOTO:
+            ost << "    goto " << label(code, i.arg) << ";\n";
+            break;
+        case OP_IFLT:
+            ost << "    if (" << next << " < " << top << ") goto " << label(code, i.arg) << ";\n";
+            depth -= 2;
+            break;
+        case OP_IFGT:
+            ost << "    if (" << next << " > " << top << ") goto " << label(code, i.arg) << ";\n";
+            depth -= 2;
+            break;
+        case OP_IFEQ:
+            ost << "    if (" << next << " == " << top << ") goto " << label(code, i.arg) << ";\n";
+            depth -= 2;
+            break;
+        case OP_END:
+            ost << "    return 0;\n";
+            break;
+        case OP_BREAK: // only ever patched into the code of a program
+            break;
+        }
+    }
+    ost << "}\n";
+    source = ost.str();
+}
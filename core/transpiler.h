@@ -0,0 +1,30 @@
+#ifndef TRANSPILER_H
+#define TRANSPILER_H
+
+#include <string>
+
+#include "program.h"
+
+/*
+ * Class: Transpiler
+ * -----------------
+ * This class translates a program into a C translation unit,
+ * to be built by the system compiler into a native executable.
+ * It is translated from the same bytecode the machine runs, so the
+ * output and errors are those of the command line runner: every
+ * variable is a local with a flag telling whether it is defined,
+ * lines are labels, jumps are gotos, PRINT and INPUT use stdio.
+ * Variables already defined in the program keep their values.
+ */
+
+class Transpiler {
+
+public:
+
+    Transpiler(Program &program);
+
+    std::string source;
+
+};
+
+#endif // TRANSPILER_H
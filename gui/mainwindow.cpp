@@ -0,0 +1,439 @@
+#include "mainwindow.h"
+#include "ui_mainwindow.h"
+#include "checkpoint.h"
+
+#include <QFile>
+#include <QFileDialog>
+#include <QString>
+#include <iostream>
+#include <sstream>
+#include <memory>
+
+/* interval between two refreshes of the output area, in milliseconds */
+static const int REFRESH_INTERVAL = 50;
+
+/* block size of the arena of a single line typed in */
+static const std::size_t LINE_ARENA = 512;
+
+MainWindow::MainWindow(QWidget *parent):
+    QMainWindow(parent),
+    name(""),
+    isRunning(false),
+    isWorking(false),
+    ui(new Ui::MainWindow),
+    program(new Program),
+    worker(new Worker) {
+    ui->setupUi(this);
+    resetModels();
+    ui->CodeDisplay->setModel(&codeModel);
+    ui->treeDisplay->setModel(&treeModel);
+    ui->btnStopCode->setEnabled(false);
+
+    worker->moveToThread(&thread);
+    connect(&thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this, &MainWindow::runRequested, worker, &Worker::run);
+    connect(worker, &Worker::finished, this, &MainWindow::onRunFinished);
+    connect(worker, &Worker::failed, this, &MainWindow::onRunFailed);
+    connect(this, &MainWindow::loadRequested, worker, &Worker::load);
+    connect(worker, &Worker::progress, this, &MainWindow::onLoadProgress);
+    connect(worker, &Worker::loaded, this, &MainWindow::onLoaded);
+    thread.start();
+
+    drainTimer.setInterval(REFRESH_INTERVAL);
+    connect(&drainTimer, &QTimer::timeout, this, &MainWindow::drainOutput);
+}
+
+MainWindow::~MainWindow() {
+    worker->stop();
+    thread.quit();
+    thread.wait();
+    delete program;
+    delete ui;
+}
+
+void MainWindow::on_cmdLineEdit_editingFinished() {
+    QString cmd = ui->cmdLineEdit->text();
+    ui->cmdLineEdit->clear();
+    if (cmd.isEmpty())
+        return;
+
+    std::string line = cmd.toStdString();
+    Tokenizer tokenizer(line);
+    if (tokenizer.tokens.empty())
+        return;
+
+    // only STOP is accepted while the program is running
+    if (isWorking) {
+        if (tokenizer.is(0, "STOP"))
+            stop();
+        else
+            UPDATE_OUT("program is running, STOP it first")
+        return;
+    }
+
+    // handle different occasions, a run waiting for input can be saved
+    if (!name.empty() && tokenizer.tokens.size() == 2 && tokenizer.is(1, "CHECKPOINT")) {
+        HANDLE(checkpoint();)
+    } else if (!name.empty()) {
+        HANDLE(variableInput(tokenizer);)
+    } else if (tokenizer.is(0, "RUN") || tokenizer.is(0, "CONTINUE")) {
+        HANDLE(run();)
+    } else if (tokenizer.is(0, "STEP")) {
+        HANDLE(run(true);)
+    } else if (tokenizer.is(0, "LOAD")) {
+        HANDLE(load();)
+    } else if (tokenizer.is(0, "STOP")) {
+        stop();
+    } else if (tokenizer.is(0, "CLEAR")) {
+        clear();
+    } else if (tokenizer.is(0, "CHECKPOINT")) {
+        HANDLE(checkpoint();)
+    } else if (tokenizer.is(0, "RESUME")) {
+        HANDLE(resume();)
+    } else if (tokenizer.is(0, "PROFILE")) {
+        profile(tokenizer);
+    } else if (tokenizer.is(0, "TRACE")) {
+        HANDLE(trace(tokenizer);)
+    } else if (tokenizer.is(0, "LIMIT")) {
+        limit(tokenizer);
+    } else if (tokenizer.is(0, "BREAK") || tokenizer.is(0, "UNBREAK")) {
+        HANDLE(breakpoint(tokenizer);)
+    } else if (tokenizer.is(0, "WATCH") || tokenizer.is(0, "UNWATCH")) {
+        watchpoint(tokenizer);
+    } else if (tokenizer.is(0, "HELP")) {
+        help();
+    } else if (tokenizer.is(0, "QUIT")) {
+        exit(0);
+    } else if (tokenizer.tokens[0].kind == T_LET ||
+             tokenizer.tokens[0].kind == T_PRINT ||
+             tokenizer.tokens[0].kind == T_INPUT) {
+        HANDLE(directInput(tokenizer);)
+    } else if (tokenizer.tokens[0].kind == T_NUMBER) {
+        HANDLE(lineInput(tokenizer);)
+    } else {
+        UPDATE_OUT("illegal command")
+    }
+
+    // to guarantee the " ? " prefix not changed
+    if (!name.empty())
+        ui->cmdLineEdit->setText(" ? ");
+}
+
+void MainWindow::on_cmdLineEdit_textEdited() {
+    // to guarantee the " ? " prefix not changed
+    if (!name.empty() && ui->cmdLineEdit->text().size() < 3)
+        ui->cmdLineEdit->setText(" ? ");
+}
+
+void MainWindow::on_btnLoadCode_clicked() {
+    HANDLE(load();)
+}
+
+void MainWindow::on_btnRunCode_clicked() {
+    HANDLE(run();)
+}
+
+void MainWindow::on_btnClearCode_clicked() {
+    clear();
+}
+
+void MainWindow::on_btnStopCode_clicked() {
+    stop();
+}
+
+void MainWindow::onRunFinished(int state, QString var) {
+    setWorking(false);
+
+    // input a variable during runtime
+    if (state == INPUTTING) {
+        name = var.toStdString();
+        ui->cmdLineEdit->setText(" ? ");
+        UPDATE_CODE
+        return;
+    }
+
+    // either ended, stopped or paused, RUN goes on from the marked line
+    UPDATE_CODE
+    if (state == PAUSED)
+        UPDATE_OUT("paused: " + var)
+    isRunning = false;
+}
+
+void MainWindow::onRunFailed(QString error) {
+    setWorking(false);
+    UPDATE_CODE
+    UPDATE_OUT(error)
+}
+
+void MainWindow::onLoadProgress(qint64 done, qint64 total) {
+    if (isWorking && total > 0)
+        ui->statusbar->showMessage(tr("正在导入 %1%").arg(done * 100 / total));
+}
+
+void MainWindow::onLoaded(QString error) {
+    setWorking(false);
+    ui->statusbar->clearMessage();
+    resetModels();
+    if (!error.isEmpty())
+        UPDATE_OUT(error)
+    for (auto &warning : program->warnings())
+        UPDATE_OUT(QString::fromStdString(warning))
+}
+
+void MainWindow::drainOutput() {
+    QString text = worker->take();
+    if (!text.isEmpty())
+        UPDATE_OUT(text)
+}
+
+void MainWindow::variableInput(Tokenizer &tokenizer) {
+    std::vector<Token> &tokens = tokenizer.tokens;
+    if (tokens.size() < 2 || tokens[1].kind != T_NUMBER || tokens[1].overflow)
+        throw ParseException("usage: ? <int>");
+
+    program->setVariable(name, tokens[1].value);
+    if (isRunning) run(); // resumes after the INPUT line and clears name
+    else name.clear();
+}
+
+void MainWindow::lineInput(Tokenizer &tokenizer) {
+    // every line typed in has an arena of its own, to be freed when replaced
+    std::unique_ptr<Arena> arena(new Arena(LINE_ARENA));
+    StmtParser parser(tokenizer, 1, *arena);
+    const Token &number = tokenizer.tokens[0];
+    if (number.overflow || number.value <= 0)
+        throw ParseException("illegal line number");
+    program->insert(number.value, parser.statement, arena.release());
+
+    codeModel.updateLine(number.value);
+    treeModel.updateLine(number.value);
+}
+
+void MainWindow::directInput(Tokenizer &tokenizer) {
+    Arena arena(LINE_ARENA);
+    StmtParser parser(tokenizer, 0, arena);
+    std::string ans;
+    ProgramState state = program->step(ans, parser.statement);
+
+    // directily input a variable
+    if (state == INPUTTING) {
+        name = ans;
+        ui->cmdLineEdit->setText(" ? ");
+        return;
+    }
+
+    // show the output on ui
+    if (!ans.empty())
+        UPDATE_OUT(QString::fromStdString(ans))
+}
+
+void MainWindow::load() {
+    QString file = QFileDialog::getOpenFileName(this, tr("从文件导入"), QCoreApplication::applicationDirPath(), tr("Basic程序文件(*.basic)"));
+    if (file.isEmpty())
+        return;
+
+    // parsed off the ui thread, shown when done
+    clear();
+    setWorking(true);
+    worker->setProgram(program);
+    emit loadRequested(file);
+}
+
+void MainWindow::run(bool stepping) {
+    isRunning = true;
+
+    // continue after the line that asked for input
+    bool skip = !name.empty();
+    name.clear();
+
+    setWorking(true);
+    worker->setProgram(program);
+    worker->clearStop();
+    emit runRequested(skip, stepping);
+}
+
+void MainWindow::stop() {
+    if (isWorking)
+        worker->stop();
+}
+
+void MainWindow::setWorking(bool working) {
+    isWorking = working;
+    ui->btnLoadCode->setEnabled(!working);
+    ui->btnRunCode->setEnabled(!working);
+    ui->btnClearCode->setEnabled(!working);
+    ui->btnStopCode->setEnabled(working);
+
+    if (working) {
+        drainTimer.start();
+    } else {
+        drainTimer.stop();
+        drainOutput();
+    }
+}
+
+void MainWindow::checkpoint() {
+    QString file = QFileDialog::getSaveFileName(this, tr("保存运行状态"), QCoreApplication::applicationDirPath(), tr("运行状态文件(*.qbck)"));
+    if (file.isEmpty())
+        return;
+
+    // a variable asked for by a direct INPUT is not part of the run
+    Checkpoint state(*program, isRunning ? name : std::string());
+    QFile out(file);
+    if (!out.open(QIODevice::WriteOnly) || out.write(state.data.data(), state.data.size()) != qint64(state.data.size()))
+        throw RuntimeException("cannot write " + file.toStdString());
+}
+
+void MainWindow::resume() {
+    QString file = QFileDialog::getOpenFileName(this, tr("恢复运行状态"), QCoreApplication::applicationDirPath(), tr("运行状态文件(*.qbck)"));
+    if (file.isEmpty())
+        return;
+    QFile in(file);
+    if (!in.open(QIODevice::ReadOnly))
+        throw RuntimeException("cannot open " + file.toStdString());
+    QByteArray bytes = in.readAll();
+    Checkpoint state(bytes.constData(), bytes.constData() + bytes.size());
+
+    // RUN goes on from the saved line, after giving the input if asked
+    clear();
+    try {
+        state.restore(program);
+    } catch (ParseException &) {
+        resetModels();
+        throw;
+    }
+    resetModels();
+    isRunning = true;
+    name = state.input;
+}
+
+void MainWindow::clear() {
+    ui->textBrowser->clear();
+    bool profiling = program->isProfiling();
+    bool recording = program->isRecording();
+    Limits limits = program->getLimits();
+    delete program;
+    program = new Program;
+    program->setProfiling(profiling);
+    program->setRecording(recording);
+    program->setLimits(limits);
+    resetModels();
+}
+
+void MainWindow::resetModels() {
+    codeModel.setProgram(program);
+    treeModel.setProgram(program);
+}
+
+void MainWindow::profile(Tokenizer &tokenizer) {
+    if (tokenizer.tokens.size() == 1) {
+        if (!program->isProfiling())
+            UPDATE_OUT("profiling is off, PROFILE ON to start it")
+        UPDATE_OUT(QString::fromStdString(program->toProfile()))
+    } else if (tokenizer.tokens.size() == 2 && tokenizer.is(1, "ON")) {
+        program->setProfiling(true);
+    } else if (tokenizer.tokens.size() == 2 && tokenizer.is(1, "OFF")) {
+        program->setProfiling(false);
+    } else if (tokenizer.tokens.size() == 2 && tokenizer.is(1, "CLEAR")) {
+        program->clearProfile();
+    } else {
+        UPDATE_OUT("usage: PROFILE [ON | OFF | CLEAR]")
+    }
+}
+
+void MainWindow::trace(Tokenizer &tokenizer) {
+    if (tokenizer.tokens.size() == 2 && tokenizer.is(1, "ON")) {
+        program->setRecording(true);
+    } else if (tokenizer.tokens.size() == 2 && tokenizer.is(1, "OFF")) {
+        program->setRecording(false);
+    } else if (tokenizer.tokens.size() == 2 && tokenizer.is(1, "CLEAR")) {
+        program->clearRecording();
+    } else if (tokenizer.tokens.size() == 1) {
+        if (!program->isRecording())
+            UPDATE_OUT("tracing is off, TRACE ON to start it")
+        QString file = QFileDialog::getSaveFileName(this, tr("保存执行轨迹"), QCoreApplication::applicationDirPath(), tr("Chrome轨迹文件(*.json)"));
+        if (file.isEmpty())
+            return;
+        std::string json = program->toTrace();
+        QFile out(file);
+        if (!out.open(QIODevice::WriteOnly) || out.write(json.data(), json.size()) != qint64(json.size()))
+            throw RuntimeException("cannot write " + file.toStdString());
+    } else {
+        UPDATE_OUT("usage: TRACE [ON | OFF | CLEAR]")
+    }
+}
+
+void MainWindow::limit(Tokenizer &tokenizer) {
+    std::vector<Token> &tokens = tokenizer.tokens;
+    Limits limits = program->getLimits();
+    if (tokens.size() == 1) {
+        UPDATE_OUT(QString("steps: %1, time: %2 ms, memory: %3 bytes (0 for no limit)")
+                   .arg(limits.steps).arg(limits.millis).arg(limits.bytes))
+        return;
+    }
+    if (tokens.size() == 2 && tokenizer.is(1, "OFF")) {
+        program->setLimits(Limits());
+        return;
+    }
+    if (tokens.size() != 3 || tokens[2].kind != T_NUMBER || tokens[2].overflow) {
+        UPDATE_OUT("usage: LIMIT [OFF | STEPS <n> | TIME <ms> | MEMORY <bytes>]")
+        return;
+    }
+    if (tokenizer.is(1, "STEPS")) {
+        limits.steps = tokens[2].value;
+    } else if (tokenizer.is(1, "TIME")) {
+        limits.millis = tokens[2].value;
+    } else if (tokenizer.is(1, "MEMORY")) {
+        limits.bytes = tokens[2].value;
+    } else {
+        UPDATE_OUT("usage: LIMIT [OFF | STEPS <n> | TIME <ms> | MEMORY <bytes>]")
+        return;
+    }
+    program->setLimits(limits);
+}
+
+void MainWindow::breakpoint(Tokenizer &tokenizer) {
+    std::vector<Token> &tokens = tokenizer.tokens;
+    if (tokens.size() == 1 && tokenizer.is(0, "BREAK")) {
+        for (auto &b : program->breakpoints())
+            UPDATE_OUT(QString::number(b.first) + (b.second.empty() ? "" : " IF " + QString::fromStdString(b.second)))
+        return;
+    }
+    if (tokens.size() < 2 || tokens[1].kind != T_NUMBER || tokens[1].overflow)
+        throw ParseException("usage: BREAK [<line> [IF <condition>]] | UNBREAK <line>");
+
+    if (tokenizer.is(0, "UNBREAK") && tokens.size() == 2)
+        program->clearBreakpoint(tokens[1].value);
+    else if (tokenizer.is(0, "BREAK") && tokens.size() == 2)
+        program->setBreakpoint(tokens[1].value);
+    else if (tokenizer.is(0, "BREAK") && tokens.size() > 3 && tokens[2].kind == T_IF)
+        program->setBreakpoint(tokens[1].value, tokenizer.source + tokens[3].offset);
+    else
+        throw ParseException("usage: BREAK [<line> [IF <condition>]] | UNBREAK <line>");
+}
+
+void MainWindow::watchpoint(Tokenizer &tokenizer) {
+    std::vector<Token> &tokens = tokenizer.tokens;
+    if (tokens.size() == 1 && tokenizer.is(0, "WATCH")) {
+        for (auto &watch : program->watchpoints())
+            UPDATE_OUT(QString::fromStdString(watch))
+    } else if (tokens.size() == 2 && tokens[1].kind >= T_NAME && tokens[1].kind <= T_END) { // keywords are names too
+        std::string var(tokenizer.source + tokens[1].offset, tokens[1].length);
+        if (tokenizer.is(0, "WATCH"))
+            program->setWatchpoint(var);
+        else
+            program->clearWatchpoint(var);
+    } else {
+        UPDATE_OUT("usage: WATCH [<variable>] | UNWATCH <variable>")
+    }
+}
+
+void MainWindow::help() {
+    UPDATE_OUT("简介：\n"
+               "编程语言BASIC（BASIC）是初学者通用符号指令代码的首字母缩写，"
+               "由约翰·凯门尼（John Kemeny）和托马斯·库尔茨（Thomas Kurtz）"
+               "于20世纪60年代中期在达特茅斯学院（Dartmouth College）开发。"
+               "这是最早设计成易于使用和学习的语言之一。尽管BASIC作为一种教学语言"
+               "已经消失殆尽，但它的思想仍然存在于微软的Visual BASIC系统中，该"
+               "系统仍在广泛使用。")
+}
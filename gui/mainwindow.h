@@ -0,0 +1,132 @@
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QMainWindow>
+#include <QThread>
+#include <QTimer>
+
+#include "worker.h"
+#include "programmodel.h"
+#include "syntaxtreemodel.h"
+#include "program.h"
+#include "parser.h"
+
+QT_BEGIN_NAMESPACE
+namespace Ui { class MainWindow; }
+QT_END_NAMESPACE
+
+class MainWindow : public QMainWindow {
+
+    Q_OBJECT
+
+public:
+
+    MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
+
+private slots:
+
+    void on_cmdLineEdit_editingFinished();
+    void on_cmdLineEdit_textEdited();
+    void on_btnLoadCode_clicked();
+    void on_btnRunCode_clicked();
+    void on_btnClearCode_clicked();
+    void on_btnStopCode_clicked();
+
+    /* messages from the worker */
+    void onRunFinished(int state, QString var);
+    void onRunFailed(QString error);
+    void onLoadProgress(qint64 done, qint64 total);
+    void onLoaded(QString error);
+    // append what the worker has printed
+    void drainOutput();
+
+signals:
+
+    void runRequested(bool skip, bool stepping);
+    void loadRequested(QString path);
+
+private:
+
+    /* some helpers */
+
+    // macro for updating the line marker in code area
+#define UPDATE_CODE { \
+    codeModel.updatePc(); \
+    treeModel.updatePc(); \
+}
+
+    // macro for updating output area
+#define UPDATE_OUT(text) { \
+    ui->textBrowser->append(text); \
+}
+
+    // macro for handling parsing and runtime errors
+#define HANDLE(code) \
+    try { \
+        code \
+    } catch(ParseException &e) { \
+        UPDATE_CODE \
+        ui->textBrowser->append(QString::fromStdString(e.what())); \
+    } catch(RuntimeException &e) { \
+        UPDATE_CODE \
+        ui->textBrowser->append(QString::fromStdString(e.what())); \
+    } catch(std::exception &e) { \
+        QString error(e.what()); \
+        ui->textBrowser->append("unknown error: " + error); \
+    }
+
+    // input variables directly or during runtime
+    void variableInput(Tokenizer &tokenizer);
+    // input a new line to the code area
+    void lineInput(Tokenizer &tokenizer);
+    // directly input and execute a statement
+    void directInput(Tokenizer &tokenizer);
+
+    /* direct commands handler */
+    void load();
+    void run(bool stepping = false);
+    void stop();
+    void clear();
+    void help();
+    // save the state of a run to a file, or go on from one
+    void checkpoint();
+    void resume();
+    // switch profiling or show the annotated listing
+    void profile(Tokenizer &tokenizer);
+    // switch recording a trace of runs or save it to a file
+    void trace(Tokenizer &tokenizer);
+    // set the limits of a run or show them
+    void limit(Tokenizer &tokenizer);
+    // set, clear or show breakpoints and watchpoints
+    void breakpoint(Tokenizer &tokenizer);
+    void watchpoint(Tokenizer &tokenizer);
+
+    // switch the ui between running and idle
+    void setWorking(bool working);
+
+private:
+
+    /* variable recorder */
+    std::string name;
+    bool isRunning;
+    // whether the worker is executing the program
+    bool isWorking;
+
+    Ui::MainWindow *ui;
+    Program *program;
+
+    /* code and tree views, updated line by line */
+    ProgramModel codeModel;
+    SyntaxTreeModel treeModel;
+    // show all the lines of the program again
+    void resetModels();
+
+    /* the program runs on this thread, its output is drained by a timer */
+    QThread thread;
+    Worker *worker;
+    QTimer drainTimer;
+
+};
+
+#endif // MAINWINDOW_H
@@ -0,0 +1,71 @@
+#include "programmodel.h"
+
+#include <algorithm>
+
+ProgramModel::ProgramModel(QObject *parent):
+    QAbstractListModel(parent),
+    program(nullptr),
+    pc(0) {
+
+}
+
+void ProgramModel::setProgram(Program *program) {
+    beginResetModel();
+    this->program = program;
+    numbers = program->lineNumbers();
+    pc = program->currentLine();
+    endResetModel();
+}
+
+void ProgramModel::updateLine(int line) {
+    int row = rowOf(line);
+    bool shown = row < (int)numbers.size() && numbers[row] == line;
+    bool exists = program->statement(line) != nullptr;
+
+    if (shown && exists) {
+        emit dataChanged(index(row), index(row));
+    } else if (shown) {
+        beginRemoveRows(QModelIndex(), row, row);
+        numbers.erase(numbers.begin() + row);
+        endRemoveRows();
+    } else if (exists) {
+        beginInsertRows(QModelIndex(), row, row);
+        numbers.insert(numbers.begin() + row, line);
+        endInsertRows();
+    }
+    updatePc();
+}
+
+void ProgramModel::updatePc() {
+    int old = pc;
+    pc = program->currentLine();
+    if (pc == old)
+        return;
+
+    // only the rows losing and gaining the marker change
+    for (int line : {old, pc}) {
+        int row = rowOf(line);
+        if (row < (int)numbers.size() && numbers[row] == line)
+            emit dataChanged(index(row), index(row));
+    }
+}
+
+int ProgramModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : (int)numbers.size();
+}
+
+QVariant ProgramModel::data(const QModelIndex &index, int role) const {
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= (int)numbers.size())
+        return QVariant();
+
+    int line = numbers[index.row()];
+    Statement *stmt = program->statement(line);
+    if (stmt == nullptr)
+        return QVariant();
+
+    return (line == pc ? "*" : " ") + QString::number(line) + " " + QString::fromStdString(stmt->toString());
+}
+
+int ProgramModel::rowOf(int line) const {
+    return std::lower_bound(numbers.begin(), numbers.end(), line) - numbers.begin();
+}
@@ -0,0 +1,49 @@
+#ifndef PROGRAMMODEL_H
+#define PROGRAMMODEL_H
+
+#include <QAbstractListModel>
+#include <vector>
+
+#include "program.h"
+
+/*
+ * Class: ProgramModel
+ * -----------------
+ * This class shows the code of a program one line per row.
+ * Rows are rendered only when the view asks for them, and it
+ * is told which line has changed, so an edit never renders
+ * the rest of the program again.
+ */
+
+class ProgramModel : public QAbstractListModel {
+
+    Q_OBJECT
+
+public:
+
+    ProgramModel(QObject *parent = nullptr);
+
+    // show another program, or the same one after a bulk change
+    void setProgram(Program *program);
+    // a line has been inserted, replaced or removed
+    void updateLine(int line);
+    // move the marker to the line under execution
+    void updatePc();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+
+    // row of a line, or of the first line after it
+    int rowOf(int line) const;
+
+    Program *program;
+
+    /* line numbers shown, in order, and the marked one */
+    std::vector<int> numbers;
+    int pc;
+
+};
+
+#endif // PROGRAMMODEL_H
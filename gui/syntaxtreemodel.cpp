@@ -0,0 +1,232 @@
+#include "syntaxtreemodel.h"
+
+#include <algorithm>
+
+SyntaxTreeModel::Node::Node(Node *parent, int row, const QString &text):
+    parent(parent),
+    row(row),
+    line(0),
+    text(text),
+    stmt(nullptr),
+    exp(nullptr),
+    fetched(false) {
+
+}
+
+SyntaxTreeModel::Node::~Node() {
+    for (Node *child : children)
+        delete child;
+}
+
+SyntaxTreeModel::SyntaxTreeModel(QObject *parent):
+    QAbstractItemModel(parent),
+    program(nullptr),
+    pc(0) {
+
+}
+
+SyntaxTreeModel::~SyntaxTreeModel() {
+    for (auto &top : cache)
+        delete top.second;
+}
+
+void SyntaxTreeModel::setProgram(Program *program) {
+    beginResetModel();
+    for (auto &top : cache)
+        delete top.second;
+    cache.clear();
+    this->program = program;
+    numbers = program->lineNumbers();
+    pc = program->currentLine();
+    endResetModel();
+}
+
+void SyntaxTreeModel::updateLine(int line) {
+    int row = rowOf(line);
+    bool shown = row < (int)numbers.size() && numbers[row] == line;
+
+    // a replaced line goes away with all its nodes and comes again
+    if (shown) {
+        beginRemoveRows(QModelIndex(), row, row);
+        numbers.erase(numbers.begin() + row);
+        drop(line);
+        endRemoveRows();
+    }
+    if (program->statement(line) != nullptr) {
+        beginInsertRows(QModelIndex(), row, row);
+        numbers.insert(numbers.begin() + row, line);
+        endInsertRows();
+    }
+    updatePc();
+}
+
+void SyntaxTreeModel::updatePc() {
+    int old = pc;
+    pc = program->currentLine();
+    if (pc == old)
+        return;
+
+    // only the rows losing and gaining the marker change
+    for (int line : {old, pc}) {
+        int row = rowOf(line);
+        if (row < (int)numbers.size() && numbers[row] == line)
+            emit dataChanged(index(row, 0), index(row, 0));
+    }
+}
+
+QModelIndex SyntaxTreeModel::index(int row, int column, const QModelIndex &parent) const {
+    if (!hasIndex(row, column, parent))
+        return QModelIndex();
+    return createIndex(row, column, parent.isValid() ? node(parent) : nullptr);
+}
+
+QModelIndex SyntaxTreeModel::parent(const QModelIndex &index) const {
+    Node *parent = static_cast<Node *>(index.internalPointer());
+    if (!index.isValid() || parent == nullptr)
+        return QModelIndex();
+    if (parent->parent == nullptr)
+        return createIndex(rowOf(parent->line), 0, nullptr);
+    return createIndex(parent->row, 0, parent->parent);
+}
+
+int SyntaxTreeModel::rowCount(const QModelIndex &parent) const {
+    if (!parent.isValid())
+        return (int)numbers.size();
+    return (int)node(parent)->children.size();
+}
+
+int SyntaxTreeModel::columnCount(const QModelIndex &) const {
+    return 1;
+}
+
+bool SyntaxTreeModel::hasChildren(const QModelIndex &parent) const {
+    if (!parent.isValid())
+        return !numbers.empty();
+    Node *n = node(parent);
+    if (n->fetched)
+        return !n->children.empty();
+    if (n->stmt != nullptr)
+        return n->stmt->type() != END;
+    return n->exp != nullptr && n->exp->type() == COMPOUND;
+}
+
+bool SyntaxTreeModel::canFetchMore(const QModelIndex &parent) const {
+    return parent.isValid() && !node(parent)->fetched && hasChildren(parent);
+}
+
+void SyntaxTreeModel::fetchMore(const QModelIndex &parent) {
+    Node *n = node(parent);
+    if (n->fetched)
+        return;
+
+    // count the children first, then make them inside the insertion
+    Node probe(nullptr, 0, QString());
+    probe.stmt = n->stmt;
+    probe.exp = n->exp;
+    expand(&probe);
+    int count = probe.children.size();
+
+    if (count == 0) {
+        n->fetched = true;
+        return;
+    }
+    beginInsertRows(parent, 0, count - 1);
+    n->children.swap(probe.children);
+    for (Node *child : n->children)
+        child->parent = n;
+    n->fetched = true;
+    endInsertRows();
+}
+
+QVariant SyntaxTreeModel::data(const QModelIndex &index, int role) const {
+    if (role != Qt::DisplayRole || !index.isValid())
+        return QVariant();
+
+    Node *n = node(index);
+    if (n->parent == nullptr)
+        return (n->line == pc ? "*" : " ") + QString::number(n->line) + " " + n->text;
+    return n->text;
+}
+
+SyntaxTreeModel::Node *SyntaxTreeModel::node(const QModelIndex &index) const {
+    Node *parent = static_cast<Node *>(index.internalPointer());
+    if (parent != nullptr)
+        return parent->children[index.row()];
+
+    int line = numbers[index.row()];
+    Node *&top = cache[line];
+    if (top == nullptr) {
+        Statement *stmt = program->statement(line);
+        static const char *const heads[] = {"REM", "LET =", "PRINT", "INPUT", "GOTO", "IF THEN", "END"};
+        top = new Node(nullptr, 0, heads[stmt->type()]);
+        top->line = line;
+        top->stmt = stmt;
+    }
+    return top;
+}
+
+void SyntaxTreeModel::expand(Node *node) {
+    Statement *stmt = node->stmt;
+    if (stmt != nullptr) {
+        switch (stmt->type()) {
+        case REM:
+            add(node, QString::fromStdString(stmt->getContent()));
+            break;
+        case LET:
+            add(node, QString::fromStdString(stmt->getIdentifierName()));
+            add(node, QString(), stmt->getExpression());
+            break;
+        case PRINT:
+            add(node, QString(), stmt->getExpression());
+            break;
+        case INPUT:
+            add(node, QString::fromStdString(stmt->getIdentifierName()));
+            break;
+        case GOTO:
+            add(node, QString::number(stmt->getLineNumber()));
+            break;
+        case IFTHEN:
+            add(node, QString(), stmt->getExpression());
+            add(node, QString::fromStdString(IfStmt::name(stmt->getOperator())));
+            add(node, QString(), stmt->getExpression1());
+            add(node, QString::number(stmt->getLineNumber()));
+            break;
+        case END:
+            break;
+        }
+    } else if (node->exp != nullptr && node->exp->type() == COMPOUND) {
+        add(node, QString(), node->exp->getLHS());
+        add(node, QString(), node->exp->getRHS());
+    }
+}
+
+void SyntaxTreeModel::add(Node *node, const QString &text, Expression *exp) {
+    Node *child = new Node(node, node->children.size(), text);
+    if (exp != nullptr) {
+        child->exp = exp;
+        switch (exp->type()) {
+        case CONSTANT:
+            child->text = QString::number(exp->getConstantValue());
+            break;
+        case IDENTIFIER:
+            child->text = QString::fromStdString(exp->getIdentifierName());
+            break;
+        case COMPOUND:
+            child->text = QString::fromStdString(CompoundExp::name(exp->getOperator()));
+            break;
+        }
+    }
+    node->children.push_back(child);
+}
+
+void SyntaxTreeModel::drop(int line) {
+    auto top = cache.find(line);
+    if (top == cache.end())
+        return;
+    delete top->second;
+    cache.erase(top);
+}
+
+int SyntaxTreeModel::rowOf(int line) const {
+    return std::lower_bound(numbers.begin(), numbers.end(), line) - numbers.begin();
+}
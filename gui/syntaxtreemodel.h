@@ -0,0 +1,83 @@
+#ifndef SYNTAXTREEMODEL_H
+#define SYNTAXTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <unordered_map>
+#include <vector>
+
+#include "program.h"
+
+/*
+ * Class: SyntaxTreeModel
+ * -----------------
+ * This class shows the syntax trees of a program, one top row
+ * per line.  Nodes are made only when the view shows or expands
+ * them, and the nodes of a line are kept until it is replaced.
+ */
+
+class SyntaxTreeModel : public QAbstractItemModel {
+
+    Q_OBJECT
+
+public:
+
+    SyntaxTreeModel(QObject *parent = nullptr);
+    ~SyntaxTreeModel();
+
+    // show another program, or the same one after a bulk change
+    void setProgram(Program *program);
+    // a line has been inserted, replaced or removed
+    void updateLine(int line);
+    // move the marker to the line under execution
+    void updatePc();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+
+    /* a node of a tree, either a statement, an expression or a leaf;
+     * the index of a node points to its parent */
+    struct Node {
+        Node *parent;
+        int row;
+        int line;
+        QString text;
+        Statement *stmt;
+        Expression *exp;
+        bool fetched;
+        std::vector<Node *> children;
+
+        Node(Node *parent, int row, const QString &text);
+        ~Node();
+    };
+
+    // node of an index, making the top node of a line if needed
+    Node *node(const QModelIndex &index) const;
+    // make the children of a node
+    void expand(Node *node);
+    void add(Node *node, const QString &text, Expression *exp = nullptr);
+    // forget the nodes of a line
+    void drop(int line);
+
+    // row of a line, or of the first line after it
+    int rowOf(int line) const;
+
+    Program *program;
+
+    /* line numbers shown, in order, and the marked one */
+    std::vector<int> numbers;
+    int pc;
+
+    /* top nodes of the lines shown so far */
+    mutable std::unordered_map<int, Node *> cache;
+
+};
+
+#endif // SYNTAXTREEMODEL_H
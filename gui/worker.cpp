@@ -0,0 +1,93 @@
+#include "worker.h"
+
+#include <QMutexLocker>
+
+#include "cache.h"
+#include "mappedfile.h"
+#include "parser.h"
+
+/* number of loops executed between two checks for output and stop */
+static const long long SLICE = 10000;
+
+Worker::Worker():
+    program(nullptr),
+    stopping(false) {
+
+}
+
+void Worker::setProgram(Program *program) {
+    this->program = program;
+}
+
+void Worker::stop() {
+    stopping = true;
+}
+
+void Worker::clearStop() {
+    stopping = false;
+}
+
+QString Worker::take() {
+    QMutexLocker locker(&mutex);
+    QString ret;
+    ret.swap(pending);
+    return ret;
+}
+
+void Worker::push(std::string &out) {
+    if (out.empty())
+        return;
+    QString text = QString::fromStdString(out);
+    out.clear();
+
+    QMutexLocker locker(&mutex);
+    if (!pending.isEmpty())
+        pending += '\n';
+    pending += text;
+}
+
+void Worker::run(bool skip, bool stepping) {
+    std::string out, var;
+    ProgramState state = RUNNING;
+
+    try {
+        do {
+            state = stepping ? program->stepOver(out, var) : program->run(out, var, skip, SLICE);
+            skip = false;
+            push(out);
+        } while (state == RUNNING && !stopping);
+    } catch (RuntimeException &e) {
+        push(out);
+        emit failed(QString::fromStdString(e.what()));
+        return;
+    } catch (std::exception &e) {
+        push(out);
+        emit failed("unknown error: " + QString(e.what()));
+        return;
+    }
+
+    emit finished(state, QString::fromStdString(var));
+}
+
+void Worker::load(QString path) {
+    MappedFile file(path.toStdString());
+    if (!file.isOpen()) {
+        emit loaded("cannot open " + path);
+        return;
+    }
+
+    try {
+        Cache cache(file.data(), file.data() + file.size(), Cache::pathOf(path.toStdString()), program,
+                    [this](std::size_t done, std::size_t total) {
+            emit progress(done, total);
+        });
+    } catch (ParseException &e) {
+        emit loaded(QString::fromStdString(e.what()));
+        return;
+    } catch (std::exception &e) {
+        emit loaded("unknown error: " + QString(e.what()));
+        return;
+    }
+
+    emit loaded(QString());
+}
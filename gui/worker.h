@@ -0,0 +1,72 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+#include "program.h"
+
+/*
+ * Class: Worker
+ * -----------------
+ * This class runs a program on a thread of its own.
+ * The program is executed slice by slice; what it prints is put
+ * into a queue which the ui drains at its own pace, and a stop
+ * request is honoured between two slices.
+ * Programs are loaded from files on that thread too.
+ */
+
+class Worker : public QObject {
+
+    Q_OBJECT
+
+public:
+
+    Worker();
+
+    // set the program to run, only while the worker is idle
+    void setProgram(Program *program);
+    // ask a running program to stop, callable from any thread
+    void stop();
+    // forget a stop request, before the next run is requested, so that
+    // a stop coming before the run starts is not lost
+    void clearStop();
+    // take everything printed since the last call
+    QString take();
+
+public slots:
+
+    // execute until END, INPUT, a breakpoint, an error or a stop
+    // request, or only the current line if stepping
+    void run(bool skip, bool stepping);
+    // load the program from a file
+    void load(QString path);
+
+signals:
+
+    // the run is over, with the state of the program and the name
+    // of the variable to be input, or why it has paused, if any
+    void finished(int state, QString var);
+    // the run is aborted by an error
+    void failed(QString error);
+    // bytes of the file loaded so far, sent from any thread
+    void progress(qint64 done, qint64 total);
+    // the file is loaded, with the error that stops it if any
+    void loaded(QString error);
+
+private:
+
+    void push(std::string &out);
+
+    Program *program;
+    std::atomic<bool> stopping;
+
+    /* output queue shared with the ui thread */
+    QMutex mutex;
+    QString pending;
+
+};
+
+#endif // WORKER_H
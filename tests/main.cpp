@@ -0,0 +1,434 @@
+#include "program.h"
+#include "parser.h"
+#include "loader.h"
+#include "batch.h"
+#include "cache.h"
+#include "checkpoint.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Regression tests of the core library.
+ * Every case prints `ok` or `FAIL` with its name, and the exit code
+ * is the number of cases failed.
+ */
+
+static int failures = 0;
+
+static void check(const char *name, bool ok, const std::string &detail = std::string()) {
+    std::cout << (ok ? "ok   " : "FAIL ") << name;
+    if (!ok && !detail.empty())
+        std::cout << ": " << detail;
+    std::cout << "\n";
+    if (!ok)
+        failures++;
+}
+
+// load a source into a program and run it to the end, the listing
+// and the output are returned, or the error met
+static std::string loadAndRun(Program &program, const char *source, std::string &listing) {
+    std::string out, var, all;
+    try {
+        Loader loader(source, source + std::strlen(source), &program);
+        listing = program.toString();
+        while (program.run(out, var) == INPUTTING)
+            program.setVariable(var, 0);
+        all = out;
+    } catch (ParseException &e) {
+        return e.what();
+    } catch (RuntimeException &e) {
+        return e.what();
+    }
+    return all;
+}
+
+// load a source into an empty program, throws ParseException
+static void load(Program &program, const char *source) {
+    Loader loader(source, source + std::strlen(source), &program);
+}
+
+// run a program to its end, giving it the inputs in order and 0 after;
+// the output, ending with the error met if any
+static std::string run(Program &program, const std::vector<int> &inputs = std::vector<int>()) {
+    std::string out, var, all;
+    std::size_t next = 0;
+    try {
+        for (bool skip = false;; skip = true) {
+            ProgramState state = program.run(out, var, skip);
+            all += out.empty() ? "" : out + "\n";
+            if (state != INPUTTING)
+                break;
+            program.setVariable(var, next < inputs.size() ? inputs[next] : 0);
+            next++;
+        }
+    } catch (RuntimeException &e) {
+        all += out.empty() ? "" : out + "\n";
+        all += e.what();
+    }
+    return all;
+}
+
+// a line that is only a number deletes that line when loaded
+static void bareLineNumbers() {
+    std::string listing;
+    {
+        Program program;
+        std::string out = loadAndRun(program, "10 PRINT 1\n20\n", listing);
+        check("bare number alone", out == "1" && listing == "*10 PRINT 1\n", out + " / " + listing);
+    }
+    {
+        Program program;
+        std::string out = loadAndRun(program, "10 PRINT 1\n20 PRINT 2\n20\n", listing);
+        check("bare number after a line", out == "1" && listing == "*10 PRINT 1\n", out + " / " + listing);
+    }
+    {
+        Program program;
+        std::string out = loadAndRun(program, "20\n10 PRINT 1\n20 PRINT 2\n", listing);
+        check("line after a bare number", out == "1\n2", out + " / " + listing);
+    }
+    {
+        // a loaded line deletes one inserted before, through the bulk insert
+        Program program;
+        std::string first;
+        loadAndRun(program, "10 PRINT 1\n20 PRINT 2\n", first);
+        std::string out = loadAndRun(program, "20\n", listing);
+        check("bare number deletes a line loaded before", out == "1" && listing == "*10 PRINT 1\n",
+              out + " / " + listing);
+    }
+    {
+        // big enough to be parsed in many chunks, every odd line deleted later
+        std::ostringstream ost;
+        const int lines = 200000;
+        for (int i = 1; i <= lines; i++)
+            ost << i << " LET X" << i % 100 << " = " << i << "\n";
+        for (int i = 1; i <= lines; i += 2)
+            ost << i << "\n";
+        std::string source = ost.str();
+        Program program;
+        loadAndRun(program, source.c_str(), listing);
+        bool ok = (int)program.statements().size() == lines / 2;
+        for (auto &stmt : program.statements())
+            ok = ok && stmt.first % 2 == 0;
+        check("bare numbers across chunks", ok, std::to_string(program.statements().size()) + " lines");
+    }
+}
+
+// jumps are resolved before the run, so one going nowhere fails at
+// the start, showing its line, even on a branch never taken
+static void badTargets() {
+    const char *sources[] = {"10 PRINT 1\n20 GOTO 15\n30 END\n", "10 PRINT 1\n20 IF 1 > 2 THEN 15\n30 END\n"};
+    for (const char *source : sources) {
+        Program program;
+        load(program, source);
+        std::string out = run(program);
+        check("bad target fails at the start", out == "runtime error: no matching line number" &&
+              program.currentLine() == 20, out + " at " + std::to_string(program.currentLine()));
+    }
+}
+
+// hot loops run by their traces give what the plain dispatch loop
+// gives, which runs when profiling; leaving a trace in the middle, by
+// a branch, an error or an INPUT, included
+static void traces() {
+    const char *sources[] = {
+        // nested loops, printing now and then
+        "5 LET S = 0\n10 LET I = 0\n20 LET J = 0\n30 LET S = S + I * J - J / 3\n40 LET J = J + 1\n"
+        "50 IF J < 300 THEN 30\n60 IF I / 50 * 50 = I THEN 80\n70 GOTO 90\n80 PRINT S\n"
+        "90 LET I = I + 1\n100 IF I < 300 THEN 20\n110 PRINT S\n",
+        // a branch out of the loop taken late, and overflow wrapping
+        "10 LET N = 27\n20 LET K = 0\n30 LET K = K + 1\n40 IF N = 1 THEN 100\n"
+        "50 IF N / 2 * 2 = N THEN 80\n60 LET N = 3 * N + 1\n70 GOTO 30\n80 LET N = N / 2\n"
+        "90 GOTO 30\n100 PRINT K\n110 LET P = 1\n120 LET P = P * 7 + K ** 3\n130 LET K = K - 1\n"
+        "140 IF K > 0 THEN 120\n150 PRINT P\n",
+        // an error deep in a hot loop
+        "5 LET X = 0\n10 LET I = 0\n20 LET X = X + 1000 / (700 - I)\n30 LET I = I + 1\n40 GOTO 20\n",
+        // INPUT in a hot loop, and a variable set only late in it
+        "10 LET I = 0\n20 LET I = I + 1\n30 IF I < 400 THEN 20\n40 INPUT A\n50 IF A > 0 THEN 70\n"
+        "60 LET Q = I\n70 PRINT A + I\n80 IF I < 900 THEN 20\n90 PRINT Q\n"
+    };
+    std::vector<int> inputs(1000, 1);
+    inputs[3] = 0;
+    for (const char *source : sources) {
+        Program traced, plain;
+        load(traced, source);
+        load(plain, source);
+        plain.setProfiling(true);
+        std::string want = run(plain, inputs), got = run(traced, inputs);
+        check("traces run as the dispatch loop", got == want, got.substr(0, 200) + " / " + want.substr(0, 200));
+    }
+}
+
+// every lane of a batch prints and fails as a run of its own does,
+// with lanes going different ways through the program
+static void batchLanes() {
+    const char *source =
+        "10 INPUT A\n20 INPUT B\n30 LET S = 0\n40 LET I = 0\n50 IF A > 5 THEN 90\n"
+        "60 LET S = S + A ** I - I / 3\n70 LET I = I + 1\n80 IF I < 20 THEN 60\n85 GOTO 120\n"
+        "90 LET S = S * 3 + 1000 / B\n100 LET A = A - 1\n110 IF A > -5 THEN 90\n"
+        "120 PRINT S\n130 IF B = 7 THEN 150\n140 PRINT S / (A - 3)\n150 END\n";
+    std::vector<std::vector<int>> inputs;
+    for (int l = 0; l < 37; l++)
+        inputs.push_back({l % 11 - 2, l % 9 - 1});
+    Program program;
+    load(program, source);
+    Batch batch(program, inputs);
+    for (int l = 0; l < 37; l++) {
+        Program alone;
+        load(alone, source);
+        std::string want = run(alone, inputs[l]), got = batch.outputs[l] + batch.errors[l];
+        if (got != want) {
+            check("batch lanes run as alone", false, "lane " + std::to_string(l) + ": " + got + " / " + want);
+            return;
+        }
+    }
+    check("batch lanes run as alone", true);
+}
+
+// a run saved at every INPUT and every slice, and restored each time
+// into a new program from the binary form, gives what it gives whole
+static void checkpoints() {
+    const char *source =
+        "10 LET S = 0\n20 LET I = 0\n30 INPUT A\n40 LET J = 0\n50 LET S = S + A * J - I\n"
+        "60 LET J = J + 1\n70 IF J < 100 THEN 50\n80 PRINT S\n90 LET I = I + 1\n100 IF I < 5 THEN 30\n"
+        "110 PRINT S / (A - 4)\n";
+    std::vector<int> inputs = {3, -7, 12, 0, 4};
+    Program whole;
+    load(whole, source);
+    std::string want = run(whole, inputs);
+
+    Program *program = new Program;
+    load(*program, source);
+    std::string out, var, got;
+    std::size_t next = 0;
+    std::size_t saves = 0;
+    try {
+        for (bool skip = false;; saves++) {
+            ProgramState state = program->run(out, var, skip, 30);
+            got += out.empty() ? "" : out + "\n";
+            if (state != RUNNING && state != INPUTTING)
+                break;
+            Checkpoint saved(*program, state == INPUTTING ? var : std::string());
+            Checkpoint read(saved.data.data(), saved.data.data() + saved.data.size());
+            delete program;
+            program = new Program;
+            read.restore(program);
+            skip = !read.input.empty();
+            if (skip)
+                program->setVariable(read.input, inputs[next++]);
+        }
+    } catch (RuntimeException &e) {
+        got += out.empty() ? "" : out + "\n";
+        got += e.what();
+    }
+    delete program;
+    check("checkpoint round trips", got == want && saves > inputs.size(), got + " / " + want);
+}
+
+// run a program to its end, going on at every stop; the output, and
+// why it stopped each time
+static std::string debug(Program &program, std::vector<std::string> &stops, long long slice = 0) {
+    std::string out, var, all;
+    for (;;) {
+        ProgramState state = program.run(out, var, false, slice);
+        all += out.empty() ? "" : out + "\n";
+        if (state == PAUSED)
+            stops.push_back(var);
+        else if (state != RUNNING)
+            return all;
+    }
+}
+
+// breakpoints stop before their line when their condition holds, also
+// in a loop already traced; watchpoints stop after a LET changes them
+static void breakpoints() {
+    const char *source =
+        "10 LET I = 0\n20 LET S = 0\n30 LET S = S + I\n40 LET I = I + 1\n50 IF I < 1000 THEN 30\n"
+        "60 PRINT S\n";
+    Program program;
+    load(program, source);
+    program.setBreakpoint(30, "I > 996");
+    std::vector<std::string> stops;
+    std::string out = debug(program, stops);
+    check("conditional breakpoint", out == "499500\n" && stops.size() == 3 &&
+          stops[0] == "breakpoint at line 30", out + " / " + std::to_string(stops.size()));
+
+    // stop half way, with the loop hot, then break in it
+    Program hot;
+    load(hot, source);
+    std::string var;
+    check("run a slice", hot.run(out, var, false, 500) == RUNNING);
+    hot.setBreakpoint(40);
+    ProgramState state = hot.run(out, var);
+    check("breakpoint in a traced loop", state == PAUSED && var == "breakpoint at line 40" &&
+          hot.currentLine() == 40, var);
+    hot.clearBreakpoint(40);
+    stops.clear();
+    out = debug(hot, stops);
+    check("cleared breakpoint", out == "499500\n" && stops.empty(), out);
+
+    Program watched;
+    load(watched, source);
+    watched.setWatchpoint("S");
+    stops.clear();
+    out = debug(watched, stops);
+    check("watchpoint", out == "499500\n" && stops.size() == 1000 &&
+          stops[0] == "`S` set to 0 at line 20" && stops[1] == "`S` changed from 0 to 1 at line 30" &&
+          stops[999] == "`S` changed from 498501 to 499500 at line 30",
+          std::to_string(stops.size()) + " " + (stops.empty() ? "" : stops[1]));
+}
+
+// precedence and associativity, the same with constants folded at
+// compile time and with variables computed at runtime
+static void precedence() {
+    // with A = 2, B = 3, C = 4 and D = 10
+    const char *cases[][3] = {
+        {"2 + 3 * 4", "A + B * C", "14"}, {"(2 + 3) * 4", "(A + B) * C", "20"},
+        {"2 * 3 ** 2", "A * B ** A", "18"}, {"2 ** 3 ** 2", "A ** B ** A", "512"},
+        {"(2 ** 3) ** 2", "(A ** B) ** A", "64"}, {"10 - 4 - 3", "D - C - B", "3"},
+        {"10 / 2 / 3", "D / A / B", "1"}, {"-2 ** 2", "-A ** A", "-4"},
+        {"2 - 3 * 4 ** 2 / 3", "A - B * C ** A / B", "-14"}
+    };
+    for (auto &c : cases) {
+        std::string listing;
+        Program folded, computed;
+        std::string source = "10 PRINT " + std::string(c[0]) + "\n";
+        std::string out = loadAndRun(folded, source.c_str(), listing);
+        source = "1 LET A = 2\n2 LET B = 3\n3 LET C = 4\n4 LET D = 10\n10 PRINT " + std::string(c[1]) + "\n";
+        std::string got = loadAndRun(computed, source.c_str(), listing);
+        check(("precedence of " + std::string(c[0])).c_str(), out == c[2] && got == c[2], out + " / " + got);
+    }
+
+    const char *bad[] = {"2 +* 3", "(2 + 3", "2 ** ", "2 3"};
+    for (const char *e : bad) {
+        Program program;
+        std::string source = "10 PRINT " + std::string(e) + "\n", listing;
+        std::string out = loadAndRun(program, source.c_str(), listing);
+        check(("parse error in " + std::string(e)).c_str(), out.compare(0, 12, "parse error:") == 0, out);
+    }
+}
+
+// a run resumed in the middle, as from a checkpoint, checks the reads
+// of the runs from line 0 after it as a fresh program would
+static void resumeThenRestart() {
+    const char *source = "10 GOTO 40\n25 IF A = 0 THEN 50\n30 LET V = 1\n40 PRINT V\n50 END\n";
+    Program fresh;
+    load(fresh, source);
+    fresh.setVariable("A", 0);
+    std::string expected = run(fresh);
+
+    Program resumed;
+    load(resumed, source);
+    resumed.setVariable("A", 0);
+    resumed.setCurrentLine(25);
+    std::string first = run(resumed);
+    std::string second = run(resumed);
+    check("resume then restart", first.empty() && second == expected, first + " / " + second + " / " + expected);
+}
+
+// constants are folded as the machine computes them, and what fails
+// at runtime is left to fail there, not while compiling
+static void foldConstants() {
+    {
+        // never run, but compiled for the warnings at load
+        Program program;
+        load(program, "10 END\n20 LET Y = (0 - 2147483647 - 1) / (0 - 1)\n");
+        program.warnings();
+        check("INT_MIN / -1 is not folded", true);
+    }
+    {
+        Program program;
+        load(program, "10 LET Y = 2 * 3\n20 PRINT Y / (1 - 1)\n");
+        std::string out = run(program);
+        check("divide by a constant 0 fails at runtime", out == "runtime error: divide by zero", out);
+    }
+    {
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point start = Clock::now();
+        Program program;
+        load(program, "10 PRINT 3 ** 2000000000\n20 PRINT 2 ** 31\n30 PRINT 7 ** (0 - 1)\n40 PRINT (0 - 1) ** 0\n");
+        std::string out = run(program);
+        bool fast = Clock::now() - start < std::chrono::seconds(1);
+        check("large powers fold at once", out == "632360961\n-2147483648\n0\n1\n" && fast, out);
+    }
+}
+
+// a time limit stops a loop of large powers soon after it is up
+static void limitPowers() {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    Program program;
+    load(program, "10 LET Y = 2000000000\n20 LET X = 3 ** Y\n30 GOTO 20\n");
+    Limits limits = Limits();
+    limits.millis = 100;
+    program.setLimits(limits);
+    std::string out = run(program);
+    bool soon = Clock::now() - start < std::chrono::seconds(2);
+    check("time limit on powers", out == "runtime error: time limit of 100 ms reached" && soon, out);
+}
+
+// lanes of a batch stop at the limits, the others run to their end
+static void limitBatch() {
+    Program program;
+    load(program, "10 INPUT A\n20 IF A > 2 THEN 50\n30 PRINT A\n40 END\n50 GOTO 50\n");
+    std::vector<std::vector<int>> inputs = {{1}, {5}, {2}};
+    Limits limits = Limits();
+    limits.steps = 1000;
+    Batch steps(program, inputs, limits);
+    check("batch instruction limit", steps.outputs[0] == "1\n" && steps.outputs[2] == "2\n" &&
+          steps.errors[0].empty() && steps.errors[2].empty() &&
+          steps.errors[1] == "runtime error: instruction limit of 1000 reached", steps.errors[1]);
+
+    limits = Limits();
+    limits.millis = 100;
+    Batch time(program, inputs, limits);
+    check("batch time limit", time.outputs[0] == "1\n" && time.errors[0].empty() &&
+          time.errors[1] == "runtime error: time limit of 100 ms reached", time.errors[1]);
+}
+
+// a program loaded from its cache runs as the one parsed, even with
+// other variables made before, which move the slots of its own
+static void cacheHits() {
+    const std::string path = "qbasic-tests.basc";
+    const char *sources[] = {
+        "10 INPUT N\n20 LET S = 0\n30 LET I = 1\n40 LET S = S + I ** 2\n"
+        "50 LET I = I + 1\n60 IF I < N + 1 THEN 40\n70 PRINT S\n80 REM done\n",
+        "10 PRINT 1\n20 GOTO 15\n"
+    };
+    for (const char *source : sources) {
+        const char *end = source + std::strlen(source);
+        std::remove(path.c_str());
+        Program parsed, missed, hit;
+        load(parsed, source);
+        Cache miss(source, end, path, &missed);
+        hit.setVariable("Z", 1);
+        hit.setVariable("S", 2);
+        Cache again(source, end, path, &hit);
+        std::string want = run(parsed, {10}), got = run(missed, {10}), cached = run(hit, {10});
+        check("cache miss then hit", !miss.hit && again.hit, source);
+        check("cache hit runs as parsed", got == want && cached == want &&
+              hit.toString() == parsed.toString(), want + " / " + got + " / " + cached);
+    }
+    std::remove(path.c_str());
+}
+
+int main() {
+    bareLineNumbers();
+    badTargets();
+    precedence();
+    resumeThenRestart();
+    foldConstants();
+    limitPowers();
+    batchLanes();
+    checkpoints();
+    breakpoints();
+    limitBatch();
+    traces();
+    cacheHits();
+    return failures;
+}